@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+    Timing helpers and JSON results with baseline comparison, shared by every
+    SimpleEQ benchmark.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/KernelDispatch.h"
+
+void BenchmarkResults::add(const juce::String& name, const juce::String& unit, double value)
+{
+    entries.push_back({ name, unit, value });
+    std::cout << name.paddedRight(' ', 48) << juce::String(value, 3).paddedLeft(' ', 12) << " " << unit << std::endl;
+}
+
+juce::var BenchmarkResults::toVar() const
+{
+    juce::Array<juce::var> results;
+
+    for (auto& entry : entries)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", entry.name);
+        result->setProperty("unit", entry.unit);
+        result->setProperty("value", entry.value);
+        results.add(juce::var(result));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+   #if SIMPLEEQ_KERNEL_DISPATCH
+    //results from different kernel variants aren't a like-for-like comparison
+    root->setProperty("kernels", CascadeKernel::getName(CascadeKernel::getKernelVariant().instructionSet));
+   #endif
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("results", results);
+
+    return juce::var(root);
+}
+
+juce::Result BenchmarkResults::writeTo(const juce::File& file) const
+{
+    if (!file.replaceWithText(juce::JSON::toString(toVar())))
+        return juce::Result::fail("can't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+int BenchmarkResults::compareWith(const juce::var& baseline, double tolerance) const
+{
+    std::map<juce::String, double> baselineValues;
+
+    if (auto* results = baseline["results"].getArray())
+        for (auto& result : *results)
+            baselineValues[result["name"].toString()] = (double)result["value"];
+
+    int regressions = 0;
+
+    for (auto& entry : entries)
+    {
+        auto found = baselineValues.find(entry.name);
+
+        if (found == baselineValues.end() || found->second <= 0.0)
+        {
+            std::cout << "new        " << entry.name << std::endl;
+            continue;
+        }
+
+        //every unit is a cost, higher is worse
+        const auto change = entry.value / found->second - 1.0;
+        const auto regressed = change > tolerance;
+
+        if (regressed)
+            ++regressions;
+
+        std::cout << (regressed ? "REGRESSION " : "ok         ") << entry.name.paddedRight(' ', 48)
+                  << (change >= 0.0 ? "+" : "") << juce::String(change * 100.0, 1) << "%" << std::endl;
+    }
+
+    return regressions;
+}
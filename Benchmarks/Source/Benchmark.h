@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Timing helpers and JSON results with baseline comparison, shared by every
+    SimpleEQ benchmark.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct BenchmarkOptions
+{
+    //each timed run lasts at least this long
+    double minSeconds{ 0.01 };
+    //timed runs per case, the median is reported
+    int repetitions{ 5 };
+    //a reduced matrix for quick checks
+    bool quick{ false };
+    //only cases whose name contains this run
+    juce::String filter;
+
+    bool shouldRun(const juce::String& name) const { return filter.isEmpty() || name.contains(filter); }
+};
+
+//returns the median seconds per iteration of body(iterations), which should run its work that many times
+template<typename Body>
+double measure(Body&& body, const BenchmarkOptions& options)
+{
+    auto time = [&body](int iterations)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        body(iterations);
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    };
+
+    //warm up and find an iteration count that runs for minSeconds
+    int iterations = 1;
+
+    for (auto elapsed = time(iterations); elapsed < options.minSeconds && iterations < (1 << 28); elapsed = time(iterations))
+        iterations = elapsed > 0.0 ? juce::jlimit(iterations * 2, 1 << 28, (int)(iterations * options.minSeconds * 1.2 / elapsed))
+                                   : iterations * 2;
+
+    std::vector<double> runs;
+
+    for (int i = 0; i < juce::jmax(1, options.repetitions); ++i)
+        runs.push_back(time(iterations) / iterations);
+
+    std::nth_element(runs.begin(), runs.begin() + (std::ptrdiff_t)(runs.size() / 2), runs.end());
+    return runs[runs.size() / 2];
+}
+
+/**
+    Named results that print as they come in and are saved as JSON.
+
+    A baseline is a previously saved results file. compareWith() matches cases
+    by name and reports every case that got slower by more than the tolerance,
+    so a run against a stored baseline fails loudly on regressions.
+*/
+class BenchmarkResults
+{
+public:
+    void add(const juce::String& name, const juce::String& unit, double value);
+
+    juce::var toVar() const;
+    juce::Result writeTo(const juce::File& file) const;
+
+    //returns the number of cases slower than the baseline by more than tolerance, e.g. 0.1 for 10%
+    int compareWith(const juce::var& baseline, double tolerance) const;
+
+private:
+    struct Entry
+    {
+        juce::String name, unit;
+        double value;
+    };
+
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    BitExactCheck.cpp
+    Compares the float cascade engine sample for sample with a chain of
+    juce::dsp::IIR::Filter objects.
+
+  ==============================================================================
+*/
+
+#include "BitExactCheck.h"
+
+#include <cstring>
+
+#include "../../Source/CascadeEngine.h"
+
+namespace
+{
+    //the chain the plugin ran before CascadeEngine, one per channel
+    using Filter = juce::dsp::IIR::Filter<float>;
+    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+    constexpr double sampleRates[] = { 44'100.0, 48'000.0, 88'200.0, 96'000.0, 192'000.0 };
+    constexpr int channelCounts[] = { 1, 2, 3, 6, 9 };
+
+    //sections above the slope keep their default coefficients, bypassed like the plugin bypassed them
+    template<int Index>
+    void setCutSection(CutFilter& cut, const juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>& coefficients, Slope slope)
+    {
+        if (Index <= slope)
+            cut.template get<Index>().coefficients = coefficients[Index];
+
+        cut.template setBypassed<Index>(Index > slope);
+    }
+
+    void setCut(CutFilter& cut, const juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>& coefficients, Slope slope)
+    {
+        setCutSection<0>(cut, coefficients, slope);
+        setCutSection<1>(cut, coefficients, slope);
+        setCutSection<2>(cut, coefficients, slope);
+        setCutSection<3>(cut, coefficients, slope);
+    }
+
+    //designed the way the plugin designed the chain, with JUCE's own FilterDesign and nothing
+    //parked, so a shortcut in makeChainCoefficients() can't hide in both sides of the comparison
+    void setChain(MonoChain& chain, const ChainSettings& settings, double sampleRate)
+    {
+        setCut(chain.get<ChainPositions::LowCut>(),
+               juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(settings.lowCutFreq, sampleRate,
+                                                                                           2 * (settings.lowCutSlope + 1)),
+               settings.lowCutSlope);
+
+        chain.get<ChainPositions::Peak>().coefficients
+            = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, settings.peakFreq, settings.peakQuality,
+                                                                  juce::Decibels::decibelsToGain(settings.peakGainInDecibels));
+
+        setCut(chain.get<ChainPositions::HighCut>(),
+               juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(settings.highCutFreq, sampleRate,
+                                                                                          2 * (settings.highCutSlope + 1)),
+               settings.highCutSlope);
+    }
+
+    //frequencies spread evenly in octaves, with the ends of the range turning up now and then
+    float randomFrequency(juce::Random& random)
+    {
+        switch (random.nextInt(8))
+        {
+            case 0:  return 20.f;
+            case 1:  return 20'000.f;
+            default: return std::round(20.f * std::pow(1'000.f, random.nextFloat()));
+        }
+    }
+
+    ChainSettings randomSettings(juce::Random& random)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = randomFrequency(random);
+        settings.highCutFreq = randomFrequency(random);
+        settings.peakFreq = randomFrequency(random);
+        //on the parameter's 0.5 dB grid, so 0 dB comes up too
+        settings.peakGainInDecibels = (float)(random.nextInt(97) - 48) * 0.5f;
+        settings.peakQuality = 0.1f + (float)random.nextInt(199) * 0.05f;
+        settings.lowCutSlope = (Slope)random.nextInt(4);
+        settings.highCutSlope = (Slope)random.nextInt(4);
+        return settings;
+    }
+
+    juce::String describe(const ChainSettings& settings, double sampleRate, int numChannels)
+    {
+        return "sr " + juce::String(sampleRate) + ", " + juce::String(numChannels) + " channel(s), low cut "
+             + juce::String(settings.lowCutFreq) + " Hz slope " + juce::String((int)settings.lowCutSlope)
+             + ", bell " + juce::String(settings.peakFreq) + " Hz " + juce::String(settings.peakGainInDecibels)
+             + " dB Q " + juce::String(settings.peakQuality) + ", high cut " + juce::String(settings.highCutFreq)
+             + " Hz slope " + juce::String((int)settings.highCutSlope);
+    }
+
+    //returns true if every sample matched
+    bool runTrial(juce::Random& random, const BitExactOptions& options)
+    {
+        const auto sampleRate = sampleRates[random.nextInt((int)std::size(sampleRates))];
+        const auto numChannels = channelCounts[random.nextInt((int)std::size(channelCounts))];
+        const auto settings = randomSettings(random);
+
+        ChainCoefficients chainCoefficients;
+        makeChainCoefficients(chainCoefficients, settings, sampleRate);
+
+        CascadeEngine<float> engine;
+        engine.prepare(numChannels, sampleRate);
+        engine.setLowCut(chainCoefficients.lowCut, chainCoefficients.lowCutSvf, chainCoefficients.lowCutSlope);
+        engine.setPeak(chainCoefficients.peak, chainCoefficients.peakSvf);
+        engine.setHighCut(chainCoefficients.highCut, chainCoefficients.highCutSvf, chainCoefficients.highCutSlope);
+
+        std::vector<MonoChain> chains((size_t)numChannels);
+        const juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)options.maxBlockSize, 1 };
+
+        for (auto& chain : chains)
+        {
+            chain.prepare(spec);
+            setChain(chain, settings, sampleRate);
+            chain.reset();
+        }
+
+        juce::AudioBuffer<float> buffer(numChannels, options.maxBlockSize), expected(numChannels, options.maxBlockSize);
+
+        //the last block is digital silence, into chains that are still ringing
+        for (int blockIndex = 0; blockIndex <= options.blocksPerTrial; ++blockIndex)
+        {
+            const auto numSamples = 1 + random.nextInt(options.maxBlockSize);
+            const auto silent = blockIndex == options.blocksPerTrial;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(channel, i, silent ? 0.f : random.nextFloat() * 2.f - 1.f);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                expected.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+                juce::dsp::AudioBlock<float> channelBlock(expected.getArrayOfWritePointers() + channel, 1, (size_t)numSamples);
+                chains[(size_t)channel].process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+            }
+
+            engine.process(juce::dsp::AudioBlock<float>(buffer).getSubBlock(0, (size_t)numSamples));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto actual = buffer.getSample(channel, i);
+                    const auto reference = expected.getSample(channel, i);
+
+                    //bitwise, so -0 against +0 counts as a difference too
+                    if (std::memcmp(&actual, &reference, sizeof(float)) != 0)
+                    {
+                        std::cout << "  mismatch in block " << blockIndex << ", channel " << channel << ", sample " << i
+                                  << ": " << actual << " instead of " << reference << "\n  "
+                                  << describe(settings, sampleRate, numChannels) << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+int runBitExactCheck(const BitExactOptions& bitExactOptions, BenchmarkResults& results)
+{
+    juce::Random random(bitExactOptions.seed);
+    int mismatchedTrials = 0;
+
+    for (int trial = 0; trial < bitExactOptions.numTrials; ++trial)
+        if (!runTrial(random, bitExactOptions))
+            ++mismatchedTrials;
+
+    std::cout << bitExactOptions.numTrials - mismatchedTrials << " of " << bitExactOptions.numTrials
+              << " trials bit-identical" << std::endl;
+
+    results.add("bit-exact/mismatched-trials", "trials", mismatchedTrials);
+    return mismatchedTrials;
+}
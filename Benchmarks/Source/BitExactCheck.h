@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    BitExactCheck.h
+    Compares the float cascade engine sample for sample with a chain of
+    juce::dsp::IIR::Filter objects.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+struct BitExactOptions
+{
+    int numTrials{ 500 };
+    //blocks in each trial run between 1 sample and this many
+    int maxBlockSize{ 1'024 };
+    int blocksPerTrial{ 16 };
+    juce::int64 seed{ 0xb17e };
+};
+
+/**
+    Each trial picks a random sample rate, channel count (mono up to more
+    channels than one SIMD lane group holds) and random settings for every
+    band, slopes included, the ends of the ranges and 0 dB bells among them.
+    It loads makeChainCoefficients() into a CascadeEngine<float>, every band
+    in direct form, and designs the plugin's original ProcessorChain of
+    IIR::Filters, one chain per channel, the way the plugin did, with
+    juce::dsp::FilterDesign and nothing parked. Noise goes through both in
+    blocks of random length, then a block of digital silence, and every
+    output sample has to be identical.
+
+    It adds bit-exact/mismatched-trials and returns that count; the first
+    mismatch of each failed trial is printed.
+*/
+int runBitExactCheck(const BitExactOptions& bitExactOptions, BenchmarkResults& results);
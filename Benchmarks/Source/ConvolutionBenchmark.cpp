@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    ConvolutionBenchmark.cpp
+    Uniform against non-uniform partitioned convolution of the linear-phase
+    FIR, paced like a real audio device.
+
+  ==============================================================================
+*/
+
+#include "ConvolutionBenchmark.h"
+
+#include <chrono>
+#include <ctime>
+#include <numeric>
+#include <thread>
+
+#include "../../Source/LinearPhaseEngine.h"
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    struct Instance
+    {
+        PartitionedConvolver convolver;
+        juce::AudioBuffer<float> buffer;
+    };
+
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+    }
+
+    double getPercentile(std::vector<double> values, double percentile)
+    {
+        const auto index = (size_t)juce::jlimit(0.0, (double)values.size() - 1.0, percentile * (double)(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + (std::ptrdiff_t)index, values.end());
+        return values[index];
+    }
+}
+
+void runConvolutionBenchmark(const ConvolutionOptions& convolutionOptions, const BenchmarkOptions& options, BenchmarkResults& results)
+{
+    juce::Random random(0xc0417);
+
+    //the shape doesn't matter for the cost, only the length
+    std::vector<float> impulse((size_t)LinearPhaseEngine::firLength);
+
+    for (auto& tap : impulse)
+        tap = (random.nextFloat() * 2.f - 1.f) * 0.01f;
+
+    const auto seconds = options.quick ? juce::jmin(1.0, convolutionOptions.seconds) : convolutionOptions.seconds;
+
+    for (auto blockSize : convolutionOptions.blockSizes)
+    {
+        const auto headSize = juce::jlimit(LinearPhaseEngine::minPartitionSize, PartitionedConvolver::maxPartitionSize,
+                                           juce::nextPowerOfTwo(blockSize));
+
+        for (auto layout : { PartitionedConvolver::Layout::uniform, PartitionedConvolver::Layout::nonUniform })
+        {
+            const auto prefix = juce::String("convolution/")
+                              + (layout == PartitionedConvolver::Layout::uniform ? "uniform" : "non-uniform")
+                              + "/b" + juce::String(blockSize);
+
+            if (!options.shouldRun(prefix + "/"))
+                continue;
+
+            std::vector<std::unique_ptr<Instance>> instances;
+
+            for (int i = 0; i < convolutionOptions.numInstances; ++i)
+            {
+                auto instance = std::make_unique<Instance>();
+                instance->convolver.prepare(numChannels, headSize, LinearPhaseEngine::firLength, convolutionOptions.sampleRate, layout);
+                instance->convolver.setActive(true);
+                instance->convolver.setImpulseResponse(impulse.data(), (int)impulse.size());
+                instance->buffer.setSize(numChannels, blockSize);
+                fillWithNoise(instance->buffer, random);
+
+                instances.push_back(std::move(instance));
+            }
+
+            const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(blockSize / convolutionOptions.sampleRate));
+            const auto numCallbacks = juce::jmax(1, juce::roundToInt(seconds * convolutionOptions.sampleRate / blockSize));
+
+            std::vector<double> callbackSeconds;
+            callbackSeconds.reserve((size_t)numCallbacks);
+
+            auto nextCallback = std::chrono::steady_clock::now();
+            const auto cpuStart = std::clock();
+
+            for (int i = 0; i < numCallbacks; ++i)
+            {
+                //like a device, callbacks come at the block period whatever the previous one cost
+                std::this_thread::sleep_until(nextCallback);
+                nextCallback += period;
+
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                for (auto& instance : instances)
+                {
+                    juce::dsp::AudioBlock<float> block(instance->buffer);
+                    instance->convolver.process(block);
+                }
+
+                callbackSeconds.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+            }
+
+            const auto cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            const auto audioSeconds = numCallbacks * blockSize / convolutionOptions.sampleRate;
+            const auto meanSeconds = std::accumulate(callbackSeconds.begin(), callbackSeconds.end(), 0.0) / (double)callbackSeconds.size();
+
+            auto lateBlocks = 0, droppedBlocks = 0;
+
+            for (auto& instance : instances)
+            {
+                lateBlocks += instance->convolver.getNumLateBlocks();
+                droppedBlocks += instance->convolver.getNumDroppedBlocks();
+            }
+
+            results.add(prefix + "/mean-callback-us", "us", meanSeconds * 1.0e6);
+            results.add(prefix + "/p99-callback-us", "us", getPercentile(callbackSeconds, 0.99) * 1.0e6);
+            results.add(prefix + "/worst-callback-us", "us", *std::max_element(callbackSeconds.begin(), callbackSeconds.end()) * 1.0e6);
+            results.add(prefix + "/cpu-percent", "%", cpuSeconds / audioSeconds * 100.0);
+            results.add(prefix + "/late-blocks", "blocks", lateBlocks);
+            results.add(prefix + "/dropped-blocks", "blocks", droppedBlocks);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    ConvolutionBenchmark.h
+    Uniform against non-uniform partitioned convolution of the linear-phase
+    FIR, paced like a real audio device.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+struct ConvolutionOptions
+{
+    //host block sizes, each one is also the head partition size
+    juce::Array<int> blockSizes{ 64, 128, 256 };
+    double sampleRate{ 48'000.0 };
+    //convolvers processed one after the other per callback, sharing the workers
+    int numInstances{ 1 };
+    //real time per case
+    double seconds{ 5.0 };
+};
+
+/**
+    Runs PartitionedConvolver with a random FIR of LinearPhaseEngine::firLength
+    taps on stereo noise, in both layouts at the same head partition, so both
+    have the same latency. Callbacks are paced at the block period so the
+    workers get the time they would have in a host; the tail work is off the
+    audio thread, which is why callback times and process CPU are reported
+    separately.
+
+    For each block size and layout it adds convolution/<layout>/b<size>/...:
+    mean-callback-us   mean time spent in the callback
+    p99-callback-us    99th percentile callback time, the jitter a host sees
+    worst-callback-us  the slowest callback
+    cpu-percent        process CPU time, workers included, relative to the
+                       audio duration
+    late-blocks        tail blocks that weren't ready when the callback
+                       needed them, computed there or left silent
+    dropped-blocks     the late blocks a worker was still on, left silent
+*/
+void runConvolutionBenchmark(const ConvolutionOptions& convolutionOptions, const BenchmarkOptions& options, BenchmarkResults& results);
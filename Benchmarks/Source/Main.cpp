@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Command line entry point for the SimpleEQ benchmarks.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "Benchmark.h"
+#include "Microbenchmarks.h"
+#include "ScalingBenchmark.h"
+#include "ConvolutionBenchmark.h"
+#include "NoiseFloorBenchmark.h"
+#include "RealtimeSafetyCheck.h"
+#include "BitExactCheck.h"
+
+static BenchmarkOptions getOptions(const juce::ArgumentList& args)
+{
+    BenchmarkOptions options;
+
+    if (args.containsOption("--min-time"))
+        options.minSeconds = juce::jmax(0.001, args.getValueForOption("--min-time").getDoubleValue());
+
+    if (args.containsOption("--repetitions"))
+        options.repetitions = juce::jmax(1, args.getValueForOption("--repetitions").getIntValue());
+
+    options.quick = args.containsOption("--quick");
+    options.filter = args.getValueForOption("--filter");
+
+    return options;
+}
+
+//saves the results and compares them with --baseline, failing on any regression
+static void finish(const juce::ArgumentList& args, const BenchmarkResults& results)
+{
+    if (args.containsOption("--output"))
+    {
+        auto result = results.writeTo(args.getFileForOption("--output"));
+
+        if (result.failed())
+            juce::ConsoleApplication::fail(result.getErrorMessage());
+    }
+
+    if (args.containsOption("--baseline"))
+    {
+        const auto baseline = juce::JSON::parse(args.getExistingFileForOption("--baseline"));
+
+        if (!baseline.isObject())
+            juce::ConsoleApplication::fail("the baseline isn't a results file");
+
+        const auto tolerance = args.containsOption("--tolerance") ? args.getValueForOption("--tolerance").getDoubleValue() / 100.0
+                                                                  : 0.1;
+
+        if (const auto regressions = results.compareWith(baseline, tolerance))
+            juce::ConsoleApplication::fail(juce::String(regressions) + " case(s) regressed by more than "
+                                           + juce::String(tolerance * 100.0) + "%", 2);
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    //the processor's parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand("--help|-h",
+                       "Usage: SimpleEQBenchmarks [command] [options]\n\n"
+                       "Options for every command:\n"
+                       "  --output <file>        save the results as JSON\n"
+                       "  --baseline <file>      compare with saved results, exit code 2 on regressions\n"
+                       "  --tolerance <percent>  slowdown allowed before a case counts as regressed, default 10\n"
+                       "  --filter <text>        only run cases whose name contains text\n"
+                       "  --quick                fewer block sizes and sample rates\n"
+                       "  --min-time <seconds>   length of each timed run, default 0.01\n"
+                       "  --repetitions <n>      timed runs per case, the median is kept, default 5\n\n"
+                       "In builds that dispatch the kernels by CPU, SIMPLEEQ_KERNELS=sse2|avx2|avx512 in the\n"
+                       "environment runs a lower variant than the best one the CPU supports.",
+                       false);
+
+    app.addDefaultCommand({ "--micro", "--micro [options]",
+                            "Single-instance processBlock, coefficient design and glide costs (the default)", {},
+                            [](const juce::ArgumentList& args)
+                            {
+                                BenchmarkResults results;
+                                runMicrobenchmarks(getOptions(args), results);
+                                finish(args, results);
+                            } });
+
+    app.addCommand({ "--scaling", "--scaling [--instances 1,2,4,...] [--block-size n] [--sample-rate hz] [--callbacks n] [--automation-rate hz]",
+                     "Many instances in one process with random automation, cost and worst-case callback time per instance count", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         ScalingOptions scalingOptions;
+
+                         if (args.containsOption("--instances"))
+                         {
+                             scalingOptions.instanceCounts.clear();
+
+                             for (auto& count : juce::StringArray::fromTokens(args.getValueForOption("--instances"), ",", {}))
+                                 if (count.getIntValue() > 0)
+                                     scalingOptions.instanceCounts.add(count.getIntValue());
+                         }
+
+                         if (args.containsOption("--block-size"))
+                             scalingOptions.blockSize = juce::jmax(1, args.getValueForOption("--block-size").getIntValue());
+
+                         if (args.containsOption("--sample-rate"))
+                             scalingOptions.sampleRate = juce::jmax(8'000.0, args.getValueForOption("--sample-rate").getDoubleValue());
+
+                         if (args.containsOption("--callbacks"))
+                             scalingOptions.numCallbacks = juce::jmax(1, args.getValueForOption("--callbacks").getIntValue());
+
+                         if (args.containsOption("--automation-rate"))
+                             scalingOptions.automationRate = juce::jmax(0.0, args.getValueForOption("--automation-rate").getDoubleValue());
+
+                         BenchmarkResults results;
+                         runScalingBenchmark(scalingOptions, getOptions(args), results);
+                         finish(args, results);
+                     } });
+
+    app.addCommand({ "--convolution", "--convolution [--block-sizes 64,128,...] [--sample-rate hz] [--instances n] [--seconds s]",
+                     "Uniform against non-uniform partitioned convolution of the linear-phase FIR, callback time, jitter and CPU", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         ConvolutionOptions convolutionOptions;
+
+                         if (args.containsOption("--block-sizes"))
+                         {
+                             convolutionOptions.blockSizes.clear();
+
+                             for (auto& size : juce::StringArray::fromTokens(args.getValueForOption("--block-sizes"), ",", {}))
+                                 if (size.getIntValue() > 0)
+                                     convolutionOptions.blockSizes.add(size.getIntValue());
+                         }
+
+                         if (args.containsOption("--sample-rate"))
+                             convolutionOptions.sampleRate = juce::jmax(8'000.0, args.getValueForOption("--sample-rate").getDoubleValue());
+
+                         if (args.containsOption("--instances"))
+                             convolutionOptions.numInstances = juce::jmax(1, args.getValueForOption("--instances").getIntValue());
+
+                         if (args.containsOption("--seconds"))
+                             convolutionOptions.seconds = juce::jmax(0.1, args.getValueForOption("--seconds").getDoubleValue());
+
+                         BenchmarkResults results;
+                         runConvolutionBenchmark(convolutionOptions, getOptions(args), results);
+                         finish(args, results);
+                     } });
+
+    app.addCommand({ "--noise-floor", "--noise-floor [--sample-rates 48000,96000,...] [--seconds s]",
+                     "Rounding noise of the IIR cascade in float and double, direct form and state-variable, against a long double reference", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         NoiseFloorOptions noiseFloorOptions;
+
+                         if (args.containsOption("--sample-rates"))
+                         {
+                             noiseFloorOptions.sampleRates.clear();
+
+                             for (auto& rate : juce::StringArray::fromTokens(args.getValueForOption("--sample-rates"), ",", {}))
+                                 if (rate.getDoubleValue() >= 8'000.0)
+                                     noiseFloorOptions.sampleRates.add(rate.getDoubleValue());
+                         }
+
+                         if (args.containsOption("--seconds"))
+                             noiseFloorOptions.seconds = juce::jmax(0.5, args.getValueForOption("--seconds").getDoubleValue());
+
+                         BenchmarkResults results;
+                         runNoiseFloorBenchmark(noiseFloorOptions, getOptions(args), results);
+                         finish(args, results);
+                     } });
+
+    app.addCommand({ "--rt-check", "--rt-check [--sample-rates 44100,96000,...] [--block-size n] [--blocks-per-step n] [--abort]",
+                     "Every slope combination and parameter range through the processor, exit code 3 if its audio thread allocates, locks or blocks", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         RealtimeSafetyOptions realtimeOptions;
+
+                         if (args.containsOption("--sample-rates"))
+                         {
+                             realtimeOptions.sampleRates.clear();
+
+                             for (auto& rate : juce::StringArray::fromTokens(args.getValueForOption("--sample-rates"), ",", {}))
+                                 if (rate.getDoubleValue() >= 8'000.0)
+                                     realtimeOptions.sampleRates.add(rate.getDoubleValue());
+                         }
+
+                         if (args.containsOption("--block-size"))
+                             realtimeOptions.blockSize = juce::jmax(1, args.getValueForOption("--block-size").getIntValue());
+
+                         if (args.containsOption("--blocks-per-step"))
+                             realtimeOptions.blocksPerStep = juce::jmax(1, args.getValueForOption("--blocks-per-step").getIntValue());
+
+                         realtimeOptions.abortOnViolation = args.containsOption("--abort");
+
+                         BenchmarkResults results;
+                         const auto violations = runRealtimeSafetyCheck(realtimeOptions, results);
+                         finish(args, results);
+
+                         if (violations > 0)
+                             juce::ConsoleApplication::fail(juce::String(violations) + " real-time violation(s) on the audio thread", 3);
+                     } });
+
+    app.addCommand({ "--bit-exact", "--bit-exact [--trials n] [--block-size n] [--seed n]",
+                     "Random settings and slopes through the float cascade and a chain of IIR::Filters, exit code 4 on any sample that differs", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         BitExactOptions bitExactOptions;
+
+                         if (args.containsOption("--trials"))
+                             bitExactOptions.numTrials = juce::jmax(1, args.getValueForOption("--trials").getIntValue());
+
+                         if (args.containsOption("--block-size"))
+                             bitExactOptions.maxBlockSize = juce::jmax(1, args.getValueForOption("--block-size").getIntValue());
+
+                         if (args.containsOption("--seed"))
+                             bitExactOptions.seed = args.getValueForOption("--seed").getLargeIntValue();
+
+                         BenchmarkResults results;
+                         const auto mismatchedTrials = runBitExactCheck(bitExactOptions, results);
+                         finish(args, results);
+
+                         if (mismatchedTrials > 0)
+                             juce::ConsoleApplication::fail(juce::String(mismatchedTrials) + " trial(s) differ from the IIR::Filter chain", 4);
+                     } });
+
+    return app.findAndRunCommand(argc, argv);
+}
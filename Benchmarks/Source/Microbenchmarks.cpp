@@ -0,0 +1,364 @@
+/*
+  ==============================================================================
+
+    Microbenchmarks.cpp
+    Per-block processing and coefficient design costs of a single instance.
+
+  ==============================================================================
+*/
+
+#include "Microbenchmarks.h"
+
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    //stops the optimiser from dropping work whose result is never used
+    volatile float sink = 0.f;
+
+    void fillWithNoise(juce::AudioBuffer<float>& buffer)
+    {
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+    }
+
+    void setParameter(SimpleEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* param = processor.apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    juce::String getSlopeName(int slope)
+    {
+        return juce::String((slope + 1) * 12);
+    }
+
+    //a spread of settings so the designers never see the same input twice in a row
+    std::array<ChainSettings, 16> makeSettingsSweep()
+    {
+        std::array<ChainSettings, 16> sweep;
+
+        for (size_t i = 0; i < sweep.size(); ++i)
+        {
+            auto& settings = sweep[i];
+            const auto position = (float)i / (float)sweep.size();
+
+            settings.lowCutFreq = 20.f * std::pow(50.f, position);
+            settings.highCutFreq = 20'000.f * std::pow(0.05f, position);
+            settings.peakFreq = 100.f * std::pow(100.f, position);
+            settings.peakGainInDecibels = -12.f + 24.f * position;
+            settings.peakQuality = 0.5f + 4.f * position;
+            settings.lowCutSlope = settings.highCutSlope = Slope_48;
+        }
+
+        return sweep;
+    }
+
+    template<typename SampleType>
+    void loadChain(CascadeEngine<SampleType>& engine, const ChainCoefficients& chainCoefficients)
+    {
+        engine.setLowCut(chainCoefficients.lowCut, chainCoefficients.lowCutSvf, chainCoefficients.lowCutSlope);
+        engine.setPeak(chainCoefficients.peak, chainCoefficients.peakSvf);
+        engine.setHighCut(chainCoefficients.highCut, chainCoefficients.highCutSvf, chainCoefficients.highCutSlope);
+    }
+
+    void runProcessBenchmarks(const BenchmarkOptions& options, BenchmarkResults& results)
+    {
+        const std::vector<int> blockSizes = options.quick ? std::vector<int>{ 64, 512, 4096 }
+                                                          : std::vector<int>{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        const std::vector<double> sampleRates = options.quick ? std::vector<double>{ 48'000.0, 192'000.0 }
+                                                              : std::vector<double>{ 44'100.0, 48'000.0, 88'200.0, 96'000.0,
+                                                                                     176'400.0, 192'000.0, 352'800.0, 384'000.0 };
+        juce::MidiBuffer midi;
+
+        for (int lowSlope = Slope_12; lowSlope <= Slope_48; ++lowSlope)
+        {
+            for (int highSlope = Slope_12; highSlope <= Slope_48; ++highSlope)
+            {
+                const auto prefix = "process/" + getSlopeName(lowSlope) + "-" + getSlopeName(highSlope);
+
+                //both cuts well inside their ranges
+                SimpleEQAudioProcessor processor;
+                setParameter(processor, "LowCut Freq", 30.f);
+                setParameter(processor, "HighCut Freq", 18'000.f);
+                setParameter(processor, "LowCut Slope", (float)lowSlope);
+                setParameter(processor, "HighCut Slope", (float)highSlope);
+                setParameter(processor, "Peak Gain", 6.f);
+
+                for (auto sampleRate : sampleRates)
+                {
+                    for (auto blockSize : blockSizes)
+                    {
+                        const auto name = prefix + "/b" + juce::String(blockSize) + "/sr" + juce::String((int)sampleRate);
+
+                        if (!options.shouldRun(name))
+                            continue;
+
+                        processor.prepareToPlay(sampleRate, blockSize);
+
+                        //the same buffer every callback, like a host; filtered noise stays clear of denormals
+                        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+                        fillWithNoise(buffer);
+
+                        const auto seconds = measure([&](int iterations)
+                        {
+                            for (int i = 0; i < iterations; ++i)
+                                processor.processBlock(buffer, midi);
+                        }, options);
+
+                        results.add(name, "ns/sample", seconds * 1.0e9 / (blockSize * numChannels));
+                        processor.releaseResources();
+                    }
+                }
+            }
+        }
+    }
+
+    //what an instance costs when it has nothing to do
+    void runIdleBenchmarks(const BenchmarkOptions& options, BenchmarkResults& results)
+    {
+        constexpr double sampleRate = 48'000.0;
+        constexpr int blockSize = 512;
+        juce::MidiBuffer midi;
+
+        auto run = [&](const juce::String& name, bool silentInput, auto&& setUp)
+        {
+            if (!options.shouldRun(name))
+                return;
+
+            SimpleEQAudioProcessor processor;
+            setUp(processor);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            fillWithNoise(buffer);
+
+            //a second of silence lets the filters ring out before the timing starts
+            if (silentInput)
+            {
+                buffer.clear();
+
+                for (int i = 0; i < (int)sampleRate / blockSize; ++i)
+                    processor.processBlock(buffer, midi);
+            }
+
+            const auto seconds = measure([&](int iterations)
+            {
+                for (int i = 0; i < iterations; ++i)
+                    processor.processBlock(buffer, midi);
+            }, options);
+
+            results.add(name, "ns/sample", seconds * 1.0e9 / (blockSize * numChannels));
+            processor.releaseResources();
+        };
+
+        //a 20 Hz low cut, a 20 kHz high cut and a 0 dB bell, the default state
+        run("idle/default-chain", false, [](SimpleEQAudioProcessor&) {});
+
+        run("idle/silence", true, [](SimpleEQAudioProcessor& processor)
+        {
+            setParameter(processor, "LowCut Freq", 30.f);
+            setParameter(processor, "LowCut Slope", (float)Slope_48);
+            setParameter(processor, "Peak Gain", 6.f);
+        });
+    }
+
+    void runDesignBenchmarks(const BenchmarkOptions& options, BenchmarkResults& results)
+    {
+        constexpr double sampleRate = 48'000.0;
+        const auto sweep = makeSettingsSweep();
+
+        auto run = [&](const juce::String& name, auto&& designOne)
+        {
+            if (!options.shouldRun(name))
+                return;
+
+            const auto seconds = measure([&](int iterations)
+            {
+                for (int i = 0; i < iterations; ++i)
+                    designOne(sweep[(size_t)i % sweep.size()]);
+            }, options);
+
+            results.add(name, "ns/call", seconds * 1.0e9);
+        };
+
+        run("design/peak", [&](const ChainSettings& settings)
+        {
+            sink = makePeakCoefficients(settings, sampleRate)[0];
+        });
+
+        CutCoefficients cut;
+
+        for (int slope = Slope_12; slope <= Slope_48; ++slope)
+        {
+            run("design/lowcut/" + getSlopeName(slope), [&](ChainSettings settings)
+            {
+                settings.lowCutSlope = (Slope)slope;
+                makeLowCutCoefficients(cut, settings, sampleRate);
+                sink = cut[0][0];
+            });
+
+            run("design/highcut/" + getSlopeName(slope), [&](ChainSettings settings)
+            {
+                settings.highCutSlope = (Slope)slope;
+                makeHighCutCoefficients(cut, settings, sampleRate);
+                sink = cut[0][0];
+            });
+        }
+
+        //the same designs through the tables CoefficientDesigner builds in prepare()
+        DesignTables tables;
+        tables.prepare(sampleRate);
+
+        run("design/table/peak", [&](const ChainSettings& settings)
+        {
+            sink = tables.makePeakCoefficients(settings)[0];
+        });
+
+        for (int slope = Slope_12; slope <= Slope_48; ++slope)
+        {
+            run("design/table/lowcut/" + getSlopeName(slope), [&](ChainSettings settings)
+            {
+                settings.lowCutSlope = (Slope)slope;
+                tables.makeLowCutCoefficients(cut, settings);
+                sink = cut[0][0];
+            });
+
+            run("design/table/highcut/" + getSlopeName(slope), [&](ChainSettings settings)
+            {
+                settings.highCutSlope = (Slope)slope;
+                tables.makeHighCutCoefficients(cut, settings);
+                sink = cut[0][0];
+            });
+        }
+
+        //what updateFilters() does after every band changed: design the
+        //whole chain, then load it into the engine
+        CascadeEngine<float> engine;
+        engine.prepare(numChannels, sampleRate);
+        ChainCoefficients chainCoefficients;
+
+        run("design/update-filters", [&](const ChainSettings& settings)
+        {
+            makeChainCoefficients(chainCoefficients, settings, sampleRate);
+            loadChain(engine, chainCoefficients);
+        });
+    }
+
+    void runGlideBenchmarks(const BenchmarkOptions& options, BenchmarkResults& results)
+    {
+        constexpr double sampleRate = 48'000.0;
+        constexpr int blockSize = 512;
+        const auto sweep = makeSettingsSweep();
+
+        //the peak designs alternate every block, so with a 20 ms ramp a glide is always in progress
+        std::array<ChainCoefficients, 2> chains;
+        makeChainCoefficients(chains[0], sweep[1], sampleRate);
+        chains[1] = chains[0];
+        chains[0].peak = makePeakCoefficients(sweep[2], sampleRate);
+        chains[0].peakSvf = makePeakSvfCoefficients(sweep[2], sampleRate);
+        chains[1].peak = makePeakCoefficients(sweep[12], sampleRate);
+        chains[1].peakSvf = makePeakSvfCoefficients(sweep[12], sampleRate);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        fillWithNoise(buffer);
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        //direct-form bands step once per interval, state-variable bands sweep every sample in between
+        for (auto topology : { CascadeTopology::directForm, CascadeTopology::stateVariable })
+        {
+            for (auto interval : { 1, 4, 16, 32, 64, 256, 1024 })
+            {
+                const auto name = juce::String(topology == CascadeTopology::directForm ? "glide/ci" : "glide/svf/ci") + juce::String(interval);
+
+                if (!options.shouldRun(name))
+                    continue;
+
+                CascadeEngine<float> engine;
+                engine.setControlInterval(interval);
+
+                for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+                    engine.setTopology(band, topology);
+
+                engine.prepare(numChannels, sampleRate);
+                loadChain(engine, chains[0]);
+
+                const auto seconds = measure([&](int iterations)
+                {
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        const auto& chain = chains[(size_t)i & 1];
+                        engine.setPeak(chain.peak, chain.peakSvf);
+                        engine.process(block);
+                    }
+                }, options);
+
+                results.add(name, "ns/sample", seconds * 1.0e9 / (blockSize * numChannels));
+            }
+        }
+    }
+
+    //the engine alone in each precision and topology, every band the same
+    template<typename SampleType>
+    void runTopologyBenchmark(const juce::String& precision, const BenchmarkOptions& options, BenchmarkResults& results)
+    {
+        constexpr int blockSize = 512;
+        const auto sampleRates = options.quick ? std::vector<double>{ 48'000.0 } : std::vector<double>{ 48'000.0, 192'000.0 };
+        const auto settings = makeSettingsSweep()[4];
+
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample(channel, i, (SampleType)(random.nextFloat() * 2.f - 1.f));
+
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+
+        for (auto topology : { CascadeTopology::directForm, CascadeTopology::stateVariable })
+        {
+            for (auto sampleRate : sampleRates)
+            {
+                const auto name = "topology/" + precision + (topology == CascadeTopology::directForm ? "-df" : "-svf")
+                                + "/sr" + juce::String((int)sampleRate);
+
+                if (!options.shouldRun(name))
+                    continue;
+
+                CascadeEngine<SampleType> engine;
+
+                for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+                    engine.setTopology(band, topology);
+
+                engine.prepare(numChannels, sampleRate);
+
+                ChainCoefficients chainCoefficients;
+                makeChainCoefficients(chainCoefficients, settings, sampleRate);
+                loadChain(engine, chainCoefficients);
+
+                const auto seconds = measure([&](int iterations)
+                {
+                    for (int i = 0; i < iterations; ++i)
+                        engine.process(block);
+                }, options);
+
+                results.add(name, "ns/sample", seconds * 1.0e9 / (blockSize * numChannels));
+            }
+        }
+    }
+}
+
+void runMicrobenchmarks(const BenchmarkOptions& options, BenchmarkResults& results)
+{
+    runDesignBenchmarks(options, results);
+    runGlideBenchmarks(options, results);
+    runTopologyBenchmark<float>("float", options, results);
+    runTopologyBenchmark<double>("double", options, results);
+    runProcessBenchmarks(options, results);
+    runIdleBenchmarks(options, results);
+}
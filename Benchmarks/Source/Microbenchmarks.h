@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    Microbenchmarks.h
+    Per-block processing and coefficient design costs of a single instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+/**
+    Runs every single-instance case and adds it to results:
+
+    process/<low>-<high>/b<block>/sr<rate>  processBlock in ns per sample per channel,
+                                            for every slope pair, block size and rate
+    design/...                              each coefficient designer in ns per call
+    glide/ci<interval>                      processing while every block retargets the peak,
+                                            for a sweep of control intervals
+    glide/svf/ci<interval>                  the same with every band a state-variable filter,
+                                            retuned every sample
+    idle/default-chain                      processBlock with a 20 Hz low cut, a 20 kHz high cut and a 0 dB bell
+    idle/silence                            processBlock on digital silence once the chain has rung out
+    topology/<precision>-<df|svf>/sr<rate>  CascadeEngine alone in ns per sample per channel,
+                                            every band in direct form or state-variable,
+                                            in float and double
+*/
+void runMicrobenchmarks(const BenchmarkOptions& options, BenchmarkResults& results);
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    NoiseFloorBenchmark.cpp
+    Rounding noise of the IIR cascade in each precision and topology, against
+    an extended-precision reference.
+
+  ==============================================================================
+*/
+
+#include "NoiseFloorBenchmark.h"
+
+#include "../../Source/CascadeEngine.h"
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+
+    ChainSettings makeSettings()
+    {
+        ChainSettings settings;
+        //the lowest LowCut, and a HighCut just below the top of its range
+        settings.lowCutFreq = 20.f;
+        settings.lowCutSlope = Slope_48;
+        settings.peakFreq = 200.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+        settings.highCutFreq = 19'999.f;
+        settings.highCutSlope = Slope_12;
+        return settings;
+    }
+
+    //the whole chain in transposed direct form II, in long double straight from the prototypes
+    class Reference
+    {
+    public:
+        explicit Reference(const ChainCoefficients& chainCoefficients)
+        {
+            auto add = [this](const SvfCoefficients& p)
+            {
+                sections.push_back(CascadeKernel::toDirectForm<long double>(p.g, p.k, p.m0, p.m1, p.m2));
+            };
+
+            for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+                add(chainCoefficients.lowCutSvf[(size_t)i]);
+
+            add(chainCoefficients.peakSvf);
+
+            for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+                add(chainCoefficients.highCutSvf[(size_t)i]);
+
+            state.resize(sections.size() * 2);
+        }
+
+        long double process(long double x) noexcept
+        {
+            for (size_t i = 0; i < sections.size(); ++i)
+            {
+                const auto& s = sections[i];
+                auto* z = &state[i * 2];
+
+                const auto y = s.b0 * x + z[0];
+                z[0] = s.b1 * x - s.a1 * y + z[1];
+                z[1] = s.b2 * x - s.a2 * y;
+                x = y;
+            }
+
+            return x;
+        }
+
+    private:
+        std::vector<CascadeKernel::Section<long double>> sections;
+        std::vector<long double> state;
+    };
+
+    template<typename SampleType>
+    double measureResidual(const ChainCoefficients& chainCoefficients, CascadeTopology topology, double sampleRate, double seconds)
+    {
+        CascadeEngine<SampleType> engine;
+
+        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+            engine.setTopology(band, topology);
+
+        engine.prepare(numChannels, sampleRate);
+        engine.setLowCut(chainCoefficients.lowCut, chainCoefficients.lowCutSvf, chainCoefficients.lowCutSlope);
+        engine.setPeak(chainCoefficients.peak, chainCoefficients.peakSvf);
+        engine.setHighCut(chainCoefficients.highCut, chainCoefficients.highCutSvf, chainCoefficients.highCutSlope);
+
+        Reference reference(chainCoefficients);
+
+        //every case hears the same noise, exactly representable in float
+        juce::Random random(0x5eed);
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+
+        const auto numSamples = juce::jmax(blockSize, (int)(seconds * sampleRate));
+        const auto settleSamples = (int)(0.25 * sampleRate);
+        double errorSquared = 0.0, referenceSquared = 0.0;
+
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(channel, i, (SampleType)((random.nextFloat() * 2.f - 1.f) * 0.1f));
+
+            //the input is the same in every channel
+            std::array<long double, blockSize> expected;
+
+            for (int i = 0; i < blockSize; ++i)
+                expected[(size_t)i] = reference.process((long double)buffer.getSample(0, i));
+
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            engine.process(block);
+
+            if (position < settleSamples)
+                continue;
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto difference = (long double)buffer.getSample(0, i) - expected[(size_t)i];
+                errorSquared += (double)(difference * difference);
+                referenceSquared += (double)(expected[(size_t)i] * expected[(size_t)i]);
+            }
+        }
+
+        //a chain that blew up still reports a finite, very large number
+        if (!std::isfinite(errorSquared))
+            return std::numeric_limits<double>::max();
+
+        return referenceSquared > 0.0 ? std::sqrt(errorSquared / referenceSquared) : 0.0;
+    }
+}
+
+void runNoiseFloorBenchmark(const NoiseFloorOptions& noiseFloorOptions, const BenchmarkOptions& options, BenchmarkResults& results)
+{
+    const auto seconds = options.quick ? juce::jmin(0.5, noiseFloorOptions.seconds) : noiseFloorOptions.seconds;
+    const auto settings = makeSettings();
+
+    for (auto sampleRate : noiseFloorOptions.sampleRates)
+    {
+        ChainCoefficients chainCoefficients;
+        makeChainCoefficients(chainCoefficients, settings, sampleRate);
+
+        auto run = [&](const juce::String& variant, auto measureVariant)
+        {
+            const auto name = "noise-floor/" + variant + "/sr" + juce::String((int)sampleRate);
+
+            if (options.shouldRun(name))
+                results.add(name, "rms-ratio", measureVariant());
+        };
+
+        run("float-df", [&] { return measureResidual<float>(chainCoefficients, CascadeTopology::directForm, sampleRate, seconds); });
+        run("float-svf", [&] { return measureResidual<float>(chainCoefficients, CascadeTopology::stateVariable, sampleRate, seconds); });
+        run("double-df", [&] { return measureResidual<double>(chainCoefficients, CascadeTopology::directForm, sampleRate, seconds); });
+        run("double-svf", [&] { return measureResidual<double>(chainCoefficients, CascadeTopology::stateVariable, sampleRate, seconds); });
+    }
+}
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    NoiseFloorBenchmark.h
+    Rounding noise of the IIR cascade in each precision and topology, against
+    an extended-precision reference.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+struct NoiseFloorOptions
+{
+    juce::Array<double> sampleRates{ 48'000.0, 96'000.0, 192'000.0, 384'000.0 };
+    //audio per case, the first quarter second is left for the filters to settle
+    double seconds{ 1.0 };
+};
+
+/**
+    Runs stereo noise through CascadeEngine with a 20 Hz 48 dB/oct low cut,
+    the bottom of its range, a +6 dB bell at 200 Hz and a 19.999 kHz
+    12 dB/oct high cut, the low cut's poles being the ones that crowd z = 1
+    as the sample rate goes up. The same
+    signal goes through the chain designed in long double from the analog
+    prototypes, and the difference is what the engine's own rounding and
+    coefficient quantisation add.
+
+    For each rate it adds noise-floor/<precision>-<topology>/sr<rate>: the RMS
+    of the difference relative to the RMS of the reference, so 1e-5 is
+    -100 dB and, like the timings, lower is better. The float direct form is
+    the same arithmetic as juce::dsp::IIR::Filter.
+*/
+void runNoiseFloorBenchmark(const NoiseFloorOptions& noiseFloorOptions, const BenchmarkOptions& options, BenchmarkResults& results);
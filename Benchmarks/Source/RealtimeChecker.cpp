@@ -0,0 +1,373 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.cpp
+    Catches allocations, locks and blocking calls made on a thread while it
+    is marked as the audio thread.
+
+  ==============================================================================
+*/
+
+//the fortified inline wrappers of read() and write() would clash with the hooks below
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeChecker.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    //ScopedAudioThread nesting depth
+    thread_local int audioThreadDepth = 0;
+    //set while a violation is being handled, so the allocations and locks that takes don't count
+    thread_local int suspended = 0;
+    //ScopedParameterDispatch nesting depth, and the mutexes the calling thread holds inside it
+    thread_local int dispatchDepth = 0;
+    thread_local int mutexesHeldInDispatch = 0;
+
+    struct ScopedSuspend
+    {
+        ScopedSuspend() noexcept { ++suspended; }
+        ~ScopedSuspend() { --suspended; }
+    };
+
+    std::atomic<RealtimeChecker::Action> action{ RealtimeChecker::Action::report };
+    std::atomic<int> numViolations{ 0 };
+
+    struct Site
+    {
+        RealtimeViolation violation;
+        const char* function;
+        juce::String stack;
+        int count;
+    };
+
+    //SpinLock rather than a mutex, a mutex would check itself
+    juce::SpinLock sitesLock;
+
+    std::vector<Site>& getSites()
+    {
+        static std::vector<Site> sites;
+        return sites;
+    }
+}
+
+//==============================================================================
+void RealtimeChecker::setAction(Action newAction) noexcept
+{
+    action.store(newAction);
+}
+
+RealtimeChecker::ScopedAudioThread::ScopedAudioThread() noexcept
+{
+    ++audioThreadDepth;
+}
+
+RealtimeChecker::ScopedAudioThread::~ScopedAudioThread()
+{
+    --audioThreadDepth;
+}
+
+RealtimeChecker::ScopedParameterDispatch::ScopedParameterDispatch() noexcept
+{
+    ++dispatchDepth;
+}
+
+RealtimeChecker::ScopedParameterDispatch::~ScopedParameterDispatch()
+{
+    if (--dispatchDepth == 0)
+        mutexesHeldInDispatch = 0;
+}
+
+void RealtimeChecker::checkMutexLock(const char* function) noexcept
+{
+    if (dispatchDepth > 0 && suspended == 0)
+    {
+        //the outermost one is the parameter's listener lock
+        if (mutexesHeldInDispatch++ == 0)
+            return;
+    }
+
+    check(RealtimeViolation::lock, function);
+}
+
+void RealtimeChecker::mutexUnlocked() noexcept
+{
+    if (dispatchDepth > 0 && suspended == 0 && mutexesHeldInDispatch > 0)
+        --mutexesHeldInDispatch;
+}
+
+void RealtimeChecker::check(RealtimeViolation violation, const char* function) noexcept
+{
+    if (audioThreadDepth == 0 || suspended > 0)
+        return;
+
+    const ScopedSuspend suspend;
+
+    numViolations.fetch_add(1);
+    auto stack = juce::SystemStats::getStackBacktrace();
+
+    if (action.load() == Action::abort)
+    {
+        std::fprintf(stderr, "%s on the audio thread: %s\n%s\n", getName(violation), function, stack.toRawUTF8());
+        std::fflush(stderr);
+        std::abort();
+    }
+
+    const juce::SpinLock::ScopedLockType sl(sitesLock);
+    auto& sites = getSites();
+
+    for (auto& site : sites)
+    {
+        if (site.function == function && site.stack == stack)
+        {
+            ++site.count;
+            return;
+        }
+    }
+
+    sites.push_back({ violation, function, std::move(stack), 1 });
+}
+
+int RealtimeChecker::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+juce::StringArray RealtimeChecker::getReports()
+{
+    const ScopedSuspend suspend;
+    const juce::SpinLock::ScopedLockType sl(sitesLock);
+
+    juce::StringArray reports;
+
+    for (auto& site : getSites())
+        reports.add(juce::String(site.count) + "x " + getName(site.violation) + ": " + site.function + "\n" + site.stack);
+
+    return reports;
+}
+
+void RealtimeChecker::clear()
+{
+    const ScopedSuspend suspend;
+    const juce::SpinLock::ScopedLockType sl(sitesLock);
+
+    getSites().clear();
+    numViolations.store(0);
+}
+
+bool RealtimeChecker::interceptsSystemCalls() noexcept
+{
+   #if JUCE_LINUX
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+const char* RealtimeChecker::getName(RealtimeViolation violation) noexcept
+{
+    switch (violation)
+    {
+        case RealtimeViolation::allocation:   return "allocation";
+        case RealtimeViolation::deallocation: return "deallocation";
+        case RealtimeViolation::lock:         return "lock";
+        case RealtimeViolation::blockingCall: return "blocking call";
+    }
+
+    return "";
+}
+
+//==============================================================================
+#if JUCE_LINUX
+
+//glibc's own allocator under its internal names, which is what malloc() itself forwards to
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* __libc_memalign(size_t, size_t);
+extern "C" void __libc_free(void*);
+
+namespace
+{
+    //the definition the hook hides, looked up once
+    template<typename Function>
+    Function* findNext(const char* name) noexcept
+    {
+        return reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+    }
+}
+
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, "posix_memalign");
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            RealtimeChecker::check(RealtimeViolation::deallocation, "free");
+
+        __libc_free(pointer);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        static auto* next = findNext<int(pthread_mutex_t*)>("pthread_mutex_lock");
+        RealtimeChecker::checkMutexLock("pthread_mutex_lock");
+        return next(mutex);
+    }
+
+    int pthread_mutex_unlock(pthread_mutex_t* mutex) noexcept
+    {
+        static auto* next = findNext<int(pthread_mutex_t*)>("pthread_mutex_unlock");
+        RealtimeChecker::mutexUnlocked();
+        return next(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+    {
+        static auto* next = findNext<int(pthread_rwlock_t*)>("pthread_rwlock_rdlock");
+        RealtimeChecker::check(RealtimeViolation::lock, "pthread_rwlock_rdlock");
+        return next(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+    {
+        static auto* next = findNext<int(pthread_rwlock_t*)>("pthread_rwlock_wrlock");
+        RealtimeChecker::check(RealtimeViolation::lock, "pthread_rwlock_wrlock");
+        return next(lock);
+    }
+
+    int sched_yield() noexcept
+    {
+        static auto* next = findNext<int()>("sched_yield");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "sched_yield");
+        return next();
+    }
+
+    int nanosleep(const timespec* duration, timespec* remaining)
+    {
+        static auto* next = findNext<int(const timespec*, timespec*)>("nanosleep");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "nanosleep");
+        return next(duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const timespec* time, timespec* remaining)
+    {
+        static auto* next = findNext<int(clockid_t, int, const timespec*, timespec*)>("clock_nanosleep");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "clock_nanosleep");
+        return next(clock, flags, time, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        static auto* next = findNext<int(useconds_t)>("usleep");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "usleep");
+        return next(microseconds);
+    }
+
+    unsigned int sleep(unsigned int seconds)
+    {
+        static auto* next = findNext<unsigned int(unsigned int)>("sleep");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "sleep");
+        return next(seconds);
+    }
+
+    ssize_t read(int fd, void* buffer, size_t size)
+    {
+        static auto* next = findNext<ssize_t(int, void*, size_t)>("read");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "read");
+        return next(fd, buffer, size);
+    }
+
+    ssize_t write(int fd, const void* buffer, size_t size)
+    {
+        static auto* next = findNext<ssize_t(int, const void*, size_t)>("write");
+        RealtimeChecker::check(RealtimeViolation::blockingCall, "write");
+        return next(fd, buffer, size);
+    }
+}
+
+#else
+
+//no portable way to hook malloc or the system's locks, but every C++ allocation comes through here
+namespace
+{
+    void* allocate(std::size_t size, const char* function)
+    {
+        RealtimeChecker::check(RealtimeViolation::allocation, function);
+
+        if (auto* pointer = std::malloc(size != 0 ? size : 1))
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+
+    void deallocate(void* pointer, const char* function) noexcept
+    {
+        if (pointer != nullptr)
+            RealtimeChecker::check(RealtimeViolation::deallocation, function);
+
+        std::free(pointer);
+    }
+}
+
+void* operator new(std::size_t size)                                    { return allocate(size, "operator new"); }
+void* operator new[](std::size_t size)                                  { return allocate(size, "operator new[]"); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept    { try { return allocate(size, "operator new"); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept  { try { return allocate(size, "operator new[]"); } catch (...) { return nullptr; } }
+
+void operator delete(void* pointer) noexcept                            { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer) noexcept                          { deallocate(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::size_t) noexcept               { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::size_t) noexcept             { deallocate(pointer, "operator delete[]"); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept     { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept   { deallocate(pointer, "operator delete[]"); }
+
+#endif
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.h
+    Catches allocations, locks and blocking calls made on a thread while it
+    is marked as the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+enum class RealtimeViolation
+{
+    allocation,
+    deallocation,
+    lock,
+    blockingCall
+};
+
+/**
+    Hooks the process's allocator, locks and blocking system calls.
+
+    Linking RealtimeChecker.cpp into an executable on Linux interposes
+    malloc and free, pthread mutexes and read-write locks (and with them
+    juce::CriticalSection, juce::WaitableEvent and std::mutex), sleeps,
+    sched_yield(), which is what a contended juce::SpinLock spins on, and
+    read() and write(). Elsewhere it replaces operator new and delete, so
+    at least every C++ allocation is caught. Each hook checks whether the
+    calling thread is inside a ScopedAudioThread and if it is records a
+    violation with the name of the call and a stack trace, or prints it and
+    aborts, before carrying on with the real function. Outside a
+    ScopedAudioThread a hook costs a thread_local load. The one lock allowed
+    is the framework's own around a ScopedParameterDispatch.
+
+    This is for the benchmark tool's --rt-check command and debug runs of it;
+    it is never linked into the plugin, where replacing the host's allocator
+    isn't ours to do.
+*/
+class RealtimeChecker
+{
+public:
+    enum class Action
+    {
+        //keep going, remember each distinct call site once
+        report,
+        //print the first violation with its stack trace and abort
+        abort
+    };
+
+    static void setAction(Action newAction) noexcept;
+
+    //marks the calling thread as the audio thread while it exists, nests
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept;
+        ~ScopedAudioThread();
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+    };
+
+    /**
+        Marks a parameter change delivered on the audio thread while it
+        exists, around setValueNotifyingHost(), as a plugin wrapper does it.
+
+        JUCE calls the parameter's listeners under the parameter's own
+        listener lock, which every automated plugin takes on the host's audio
+        thread and which nothing else holds for long, so the outermost mutex
+        taken inside is let through. Allocations, blocking calls and any lock
+        a listener takes inside that one still count.
+    */
+    struct ScopedParameterDispatch
+    {
+        ScopedParameterDispatch() noexcept;
+        ~ScopedParameterDispatch();
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedParameterDispatch)
+    };
+
+    //called by the hooks
+    static void check(RealtimeViolation violation, const char* function) noexcept;
+    static void checkMutexLock(const char* function) noexcept;
+    static void mutexUnlocked() noexcept;
+
+    static int getNumViolations() noexcept;
+    //one entry per distinct call site: what was called, how often, and the first stack trace
+    static juce::StringArray getReports();
+    static void clear();
+
+    //whether malloc, locks and system calls are hooked as well as operator new and delete
+    static bool interceptsSystemCalls() noexcept;
+
+    static const char* getName(RealtimeViolation violation) noexcept;
+};
@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyCheck.cpp
+    Drives the processor through every slope combination and parameter range
+    and counts what its audio thread does that it mustn't.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafetyCheck.h"
+
+#include "RealtimeChecker.h"
+#include "../../Source/PluginProcessor.h"
+
+//defined in PluginProcessor.cpp, how every plugin wrapper creates instances
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    enum class Mode
+    {
+        minimumPhase,
+        linearPhase,
+        morph
+    };
+
+    const char* getName(Mode mode)
+    {
+        switch (mode)
+        {
+            case Mode::minimumPhase: return "minimum-phase";
+            case Mode::linearPhase:  return "linear-phase";
+            case Mode::morph:        return "morph";
+        }
+
+        return "";
+    }
+
+    //each range end, the points just inside them and a few in between
+    struct Sweep
+    {
+        const char* parameterID;
+        std::vector<float> values;
+    };
+
+    const Sweep sweeps[] =
+    {
+        { "LowCut Freq",  { 20.f, 21.f, 200.f, 2'000.f, 19'999.f, 20'000.f, 20.f } },
+        { "HighCut Freq", { 20'000.f, 19'999.f, 2'000.f, 200.f, 21.f, 20.f, 20'000.f } },
+        { "Peak Freq",    { 20.f, 750.f, 20'000.f, 750.f } },
+        { "Peak Gain",    { -24.f, 0.f, 24.f, 6.f } },
+        { "Peak Quality", { 0.1f, 10.f, 1.f } },
+    };
+
+    void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    template<typename SampleType>
+    class Driver
+    {
+    public:
+        Driver(SimpleEQAudioProcessor& processorToUse, const RealtimeSafetyOptions& realtimeOptions) :
+            processor(processorToUse), options(realtimeOptions)
+        {
+            buffer.setSize(numChannels, options.blockSize);
+        }
+
+        //a parameter change delivered in the first callback, as automation is, then noise and silence
+        void step(const juce::String& parameterID, float value)
+        {
+            for (int block = 0; block < options.blocksPerStep; ++block)
+            {
+                //the second half of the blocks is digital silence, into a chain that may still ring
+                const auto silent = block >= (options.blocksPerStep + 1) / 2;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    for (int i = 0; i < options.blockSize; ++i)
+                        buffer.setSample(channel, i, silent ? SampleType(0) : SampleType(random.nextFloat() * 2.f - 1.f));
+
+                {
+                    const RealtimeChecker::ScopedAudioThread audioThread;
+
+                    if (block == 0)
+                    {
+                        const RealtimeChecker::ScopedParameterDispatch dispatch;
+                        setParameter(processor, parameterID, value);
+                    }
+
+                    processor.processBlock(buffer, midi);
+                }
+
+                //room for the designer thread to pick the change up and publish, so the
+                //remaining callbacks see the redesign, glide or mode change
+                if (block == 0)
+                    juce::Thread::sleep(CoefficientDesignerThread::pollIntervalMs + 1);
+            }
+        }
+
+    private:
+        SimpleEQAudioProcessor& processor;
+        const RealtimeSafetyOptions& options;
+
+        juce::AudioBuffer<SampleType> buffer;
+        juce::MidiBuffer midi;
+        juce::Random random{ 0x5afe };
+    };
+
+    template<typename SampleType>
+    void runConfiguration(SimpleEQAudioProcessor& processor, const RealtimeSafetyOptions& realtimeOptions, Mode mode)
+    {
+        Driver<SampleType> driver(processor, realtimeOptions);
+
+        driver.step("Linear Phase", mode == Mode::linearPhase ? 1.f : 0.f);
+        driver.step("Snapshot Morph", mode == Mode::morph ? 1.f : 0.f);
+
+        for (int lowCutSlope = Slope_12; lowCutSlope <= Slope_48; ++lowCutSlope)
+        {
+            for (int highCutSlope = Slope_12; highCutSlope <= Slope_48; ++highCutSlope)
+            {
+                driver.step("LowCut Slope", (float)lowCutSlope);
+                driver.step("HighCut Slope", (float)highCutSlope);
+
+                for (auto& sweep : sweeps)
+                    for (auto value : sweep.values)
+                        driver.step(sweep.parameterID, value);
+
+                if (mode == Mode::morph)
+                    for (auto morph : { 0.f, 0.5f, 1.f, 0.f })
+                        driver.step("Morph", morph);
+            }
+        }
+    }
+
+    //two snapshots far enough apart that every band moves along the morph
+    void storeSnapshots(SimpleEQAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Freq", 40.f);
+        setParameter(processor, "HighCut Freq", 16'000.f);
+        setParameter(processor, "Peak Gain", -12.f);
+        processor.storeSnapshot(0);
+
+        setParameter(processor, "LowCut Freq", 400.f);
+        setParameter(processor, "HighCut Freq", 4'000.f);
+        setParameter(processor, "LowCut Slope", (float)Slope_48);
+        setParameter(processor, "Peak Gain", 12.f);
+        processor.storeSnapshot(1);
+    }
+
+    //every configuration with an editor open, on the thread that stands in for the host's audio thread
+    int runConfigurations(const RealtimeSafetyOptions& realtimeOptions, BenchmarkResults& results)
+    {
+        int totalViolations = 0;
+
+        for (auto sampleRate : realtimeOptions.sampleRates)
+        {
+            for (auto doublePrecision : { false, true })
+            {
+                for (auto topology : { CascadeTopology::directForm, CascadeTopology::stateVariable })
+                {
+                    for (auto mode : { Mode::minimumPhase, Mode::linearPhase, Mode::morph })
+                    {
+                        std::unique_ptr<juce::AudioProcessor> instance(createPluginFilter());
+                        auto& processor = dynamic_cast<SimpleEQAudioProcessor&>(*instance);
+
+                        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+                            processor.setBandTopology(band, topology);
+
+                        //the editor's controls and response curve listen to the parameters too
+                        std::unique_ptr<juce::AudioProcessorEditor> editor;
+
+                        {
+                            //set up on the message thread, as a host does
+                            const juce::MessageManagerLock messageManagerLock;
+
+                            if (mode == Mode::morph)
+                                storeSnapshots(processor);
+
+                            processor.setProcessingPrecision(doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                             : juce::AudioProcessor::singlePrecision);
+                            processor.setRateAndBufferSizeDetails(sampleRate, realtimeOptions.blockSize);
+                            processor.prepareToPlay(sampleRate, realtimeOptions.blockSize);
+                            editor.reset(processor.createEditorIfNeeded());
+                        }
+
+                        const auto before = RealtimeChecker::getNumViolations();
+
+                        if (doublePrecision)
+                            runConfiguration<double>(processor, realtimeOptions, mode);
+                        else
+                            runConfiguration<float>(processor, realtimeOptions, mode);
+
+                        const auto violations = RealtimeChecker::getNumViolations() - before;
+                        totalViolations += violations;
+
+                        results.add("rt-check/" + juce::String(doublePrecision ? "double" : "float")
+                                    + (topology == CascadeTopology::stateVariable ? "-svf/" : "-df/")
+                                    + getName(mode) + "/sr" + juce::String(juce::roundToInt(sampleRate)),
+                                    "violations", violations);
+
+                        {
+                            const juce::MessageManagerLock messageManagerLock;
+                            editor.reset();
+                            processor.releaseResources();
+                        }
+                    }
+                }
+            }
+        }
+
+        return totalViolations;
+    }
+
+    //runs the configurations like a host's audio thread, then lets the message thread's loop return
+    class AudioThread : public juce::Thread
+    {
+    public:
+        AudioThread(const RealtimeSafetyOptions& realtimeOptions, BenchmarkResults& resultsToAddTo) :
+            juce::Thread("rt-check audio"), options(realtimeOptions), results(resultsToAddTo)
+        {
+        }
+
+        ~AudioThread() override
+        {
+            stopThread(-1);
+        }
+
+        void run() override
+        {
+            totalViolations = runConfigurations(options, results);
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+        }
+
+        //after the thread has finished
+        int getTotalViolations() const noexcept { return totalViolations; }
+
+    private:
+        const RealtimeSafetyOptions& options;
+        BenchmarkResults& results;
+        int totalViolations{ 0 };
+    };
+}
+
+int runRealtimeSafetyCheck(const RealtimeSafetyOptions& realtimeOptions, BenchmarkResults& results)
+{
+    RealtimeChecker::setAction(realtimeOptions.abortOnViolation ? RealtimeChecker::Action::abort
+                                                                : RealtimeChecker::Action::report);
+    RealtimeChecker::clear();
+
+    if (!RealtimeChecker::interceptsSystemCalls())
+        std::cout << "only operator new and delete are checked on this platform" << std::endl;
+
+    //automation arrives on the audio thread while this one dispatches messages, as in a host, so a listener
+    //that hands its work to the message thread is checked doing exactly that
+    AudioThread audioThread(realtimeOptions, results);
+    audioThread.startThread();
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    audioThread.stopThread(-1);
+
+    //each distinct call site once, with where it came from
+    for (auto& report : RealtimeChecker::getReports())
+        std::cout << "\n" << report << std::endl;
+
+    return audioThread.getTotalViolations();
+}
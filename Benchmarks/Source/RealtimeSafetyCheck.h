@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyCheck.h
+    Drives the processor through every slope combination and parameter range
+    and counts what its audio thread does that it mustn't.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+struct RealtimeSafetyOptions
+{
+    juce::Array<double> sampleRates{ 44'100.0, 96'000.0 };
+    int blockSize{ 256 };
+    //callbacks after each parameter change
+    int blocksPerStep{ 4 };
+    //print the first violation's stack trace and abort instead of counting
+    bool abortOnViolation{ false };
+};
+
+/**
+    For every sample rate, processing precision, topology (every band in
+    direct form or every band state-variable) and mode (minimum phase,
+    linear phase, snapshot morph), creates a processor and steps it through
+    all 16 LowCut/HighCut slope combinations. At each combination it sweeps
+    every frequency, gain, Q and the morph position across its range,
+    ends included, with noise and then digital silence going through
+    blocksPerStep callbacks after every change.
+
+    Each change is automation: it goes through setValueNotifyingHost() at
+    the start of a callback, inside the same
+    RealtimeChecker::ScopedAudioThread as that processBlock(), so every
+    parameter listener runs under the check, the open editor's included.
+    Only the parameter's own listener lock is let through, see
+    ScopedParameterDispatch. After that first callback the designer thread
+    gets a poll interval to publish, so the rest pick up redesigns, glides
+    and mode changes.
+
+    The callbacks run on a thread of their own while the calling thread,
+    which has to be the message thread, runs the dispatch loop as a host's
+    would, so a listener that hands its work to the message thread is
+    checked doing exactly that. JUCE only runs that loop once per process.
+
+    It adds rt-check/<precision>-<topology>/<mode>/sr<rate> with the number
+    of violations in that configuration, and returns the total.
+*/
+int runRealtimeSafetyCheck(const RealtimeSafetyOptions& realtimeOptions, BenchmarkResults& results);
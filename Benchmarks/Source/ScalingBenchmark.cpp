@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ScalingBenchmark.cpp
+    Many SimpleEQ instances in one process, driven like a host session.
+
+  ==============================================================================
+*/
+
+#include "ScalingBenchmark.h"
+
+#include <ctime>
+#include <numeric>
+
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/CoefficientCache.h"
+
+//defined in PluginProcessor.cpp, how every plugin wrapper creates instances
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    struct Instance
+    {
+        std::unique_ptr<juce::AudioProcessor> processor;
+        juce::AudioBuffer<float> buffer;
+    };
+
+    void setRandomValue(juce::AudioProcessorParameter& parameter, juce::Random& random)
+    {
+        parameter.setValueNotifyingHost(random.nextFloat());
+    }
+
+    std::vector<Instance> createInstances(int count, const ScalingOptions& scalingOptions, juce::Random& random)
+    {
+        std::vector<Instance> instances((size_t)count);
+
+        for (auto& instance : instances)
+        {
+            instance.processor.reset(createPluginFilter());
+
+            auto& processor = *instance.processor;
+
+            //a random starting point per instance, like a real session
+            for (auto* parameter : processor.getParameters())
+                setRandomValue(*parameter, random);
+
+            processor.setRateAndBufferSizeDetails(scalingOptions.sampleRate, scalingOptions.blockSize);
+            processor.prepareToPlay(scalingOptions.sampleRate, scalingOptions.blockSize);
+
+            instance.buffer.setSize(numChannels, scalingOptions.blockSize);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < scalingOptions.blockSize; ++i)
+                    instance.buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+        }
+
+        return instances;
+    }
+}
+
+void runScalingBenchmark(const ScalingOptions& scalingOptions, const BenchmarkOptions& options, BenchmarkResults& results)
+{
+    juce::Random random(0x5ca1e);
+    juce::MidiBuffer midi;
+
+    const auto blockSeconds = scalingOptions.blockSize / scalingOptions.sampleRate;
+    //chance that a given instance gets a parameter change in a given callback
+    const auto automationProbability = juce::jlimit(0.0, 1.0, scalingOptions.automationRate * blockSeconds);
+
+    std::cout << "sizeof(SimpleEQAudioProcessor) = " << sizeof(SimpleEQAudioProcessor) << " bytes" << std::endl;
+
+    //the instances' designers share it, holding it here keeps it alive from one count to the next
+    juce::SharedResourcePointer<CoefficientCache> cache;
+
+    for (auto count : scalingOptions.instanceCounts)
+    {
+        const auto prefix = "scaling/n" + juce::String(count);
+
+        if (!options.shouldRun(prefix + "/"))
+            continue;
+
+        const auto cacheStart = cache->getStatistics();
+        auto instances = createInstances(count, scalingOptions, random);
+
+        auto runCallback = [&]
+        {
+            for (auto& instance : instances)
+            {
+                //hosts deliver automation from the audio thread just before processing
+                if (random.nextDouble() < automationProbability)
+                {
+                    auto& parameters = instance.processor->getParameters();
+                    setRandomValue(*parameters[random.nextInt(parameters.size())], random);
+                }
+
+                instance.processor->processBlock(instance.buffer, midi);
+            }
+        };
+
+        //let the designers settle and the caches warm up
+        for (int i = 0; i < 50; ++i)
+            runCallback();
+
+        std::vector<double> callbackSeconds;
+        callbackSeconds.reserve((size_t)scalingOptions.numCallbacks);
+
+        const auto cpuStart = std::clock();
+
+        for (int i = 0; i < scalingOptions.numCallbacks; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            runCallback();
+            callbackSeconds.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+        }
+
+        const auto cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        const auto audioSeconds = blockSeconds * scalingOptions.numCallbacks;
+
+        const auto meanSeconds = std::accumulate(callbackSeconds.begin(), callbackSeconds.end(), 0.0) / (double)callbackSeconds.size();
+        const auto worstSeconds = *std::max_element(callbackSeconds.begin(), callbackSeconds.end());
+
+        results.add(prefix + "/ns-per-sample", "ns/sample", meanSeconds * 1.0e9 / ((double)count * scalingOptions.blockSize * numChannels));
+        results.add(prefix + "/mean-callback-us", "us", meanSeconds * 1.0e6);
+        results.add(prefix + "/worst-callback-us", "us", worstSeconds * 1.0e6);
+        results.add(prefix + "/cpu-percent", "%", cpuSeconds / audioSeconds * 100.0);
+
+        const auto cacheEnd = cache->getStatistics();
+        const auto lookups = (cacheEnd.hits - cacheStart.hits) + (cacheEnd.misses - cacheStart.misses);
+
+        if (lookups > 0)
+            results.add(prefix + "/design-cache-hit-percent", "%", (double)(cacheEnd.hits - cacheStart.hits) / (double)lookups * 100.0);
+
+        results.add(prefix + "/design-cache-entries", "entries", (double)cacheEnd.numEntries);
+
+        if (meanSeconds > blockSeconds)
+            std::cout << "  " << count << " instances no longer run in real time at this block size" << std::endl;
+
+        //processors go away here, on the thread that created them
+        for (auto& instance : instances)
+            instance.processor->releaseResources();
+    }
+}
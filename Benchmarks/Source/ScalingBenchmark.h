@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    ScalingBenchmark.h
+    Many SimpleEQ instances in one process, driven like a host session.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+struct ScalingOptions
+{
+    //instance counts to step through
+    juce::Array<int> instanceCounts{ 1, 2, 4, 8, 16, 32, 64, 128, 160, 256 };
+    double sampleRate{ 48'000.0 };
+    int blockSize{ 256 };
+    //audio callbacks timed per instance count
+    int numCallbacks{ 2000 };
+    //random parameter changes per instance per second
+    double automationRate{ 10.0 };
+};
+
+/**
+    Creates N processors through createPluginFilter(), each with its own
+    buffers and random slopes, and runs them one after the other per audio
+    callback, the way a host renders a session on one audio thread. Every
+    instance gets random automation through its apvts parameters at the
+    given rate.
+
+    For each N it adds scaling/n<N>/...:
+    ns-per-sample     mean cost per sample per channel per instance; flat means
+                      linear scaling, growth shows cache pressure
+    mean-callback-us  mean time for one callback across all instances
+    worst-callback-us the slowest callback, what decides dropouts
+    cpu-percent       process CPU time, the designer thread included, relative to
+                      the audio duration rendered
+*/
+void runScalingBenchmark(const ScalingOptions& scalingOptions, const BenchmarkOptions& options, BenchmarkResults& results);
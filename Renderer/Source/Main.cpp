@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Command line entry point for the SimpleEQ offline batch renderer.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "OfflineRenderer.h"
+
+static void printUsage()
+{
+    std::cout << "Usage: SimpleEQRenderer --output <dir> [options] <files...>" << std::endl
+              << std::endl
+              << "  --preset <file>       state saved from the plugin (getStateInformation)" << std::endl
+              << "  --set \"<id>=<value>\"  set a parameter, e.g. --set \"Peak Freq=1200\"; repeatable" << std::endl
+              << "  --file-list <file>    text file with one input path per line" << std::endl
+              << "  --threads <n>         worker threads, default: one per CPU" << std::endl
+              << "  --block-size <n>      samples per processing block, default 8192" << std::endl
+              << "  --chunk-seconds <s>   with fewer files than threads, split each file into" << std::endl
+              << "                        chunks of this length rendered in parallel, default 10" << std::endl
+              << "  --verify              check chunked renders against a serial render" << std::endl
+              << "  --overwrite           replace existing output files" << std::endl
+              << "  --save-preset <file>  write the resulting state, e.g. to reuse with --preset" << std::endl;
+}
+
+//numbers are taken in the parameter's own units, anything else as its display text
+static juce::Result applyParameter(SimpleEQAudioProcessor& processor, const juce::String& assignment)
+{
+    const auto id = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+    const auto valueText = assignment.fromFirstOccurrenceOf("=", false, false).trim();
+
+    auto* param = processor.apvts.getParameter(id);
+
+    if (param == nullptr || valueText.isEmpty())
+        return juce::Result::fail("bad parameter assignment \"" + assignment + "\"");
+
+    const auto isNumber = valueText.containsOnly("0123456789.-+eE");
+    const auto normalised = isNumber ? param->convertTo0to1(valueText.getFloatValue())
+                                     : param->getValueForText(valueText);
+
+    param->setValueNotifyingHost(normalised);
+    return juce::Result::ok();
+}
+
+static juce::Result addFileList(juce::Array<juce::File>& files, const juce::File& list)
+{
+    if (!list.existsAsFile())
+        return juce::Result::fail("no such file list " + list.getFullPathName());
+
+    juce::StringArray lines;
+    list.readLines(lines);
+
+    for (auto& line : lines)
+        if (line.trim().isNotEmpty())
+            files.add(juce::File::getCurrentWorkingDirectory().getChildFile(line.trim()));
+
+    return juce::Result::ok();
+}
+
+int main (int argc, char* argv[])
+{
+    //the processor's parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    RenderSettings settings;
+    juce::Array<juce::File> files;
+    juce::File savePresetFile;
+
+    //the state every worker starts from
+    SimpleEQAudioProcessor stateProcessor;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        auto nextValue = [&]() { return i + 1 < args.size() ? args[++i].text : juce::String(); };
+        auto fail = [](const juce::String& message) { std::cerr << message << std::endl; return 1; };
+
+        if (arg == "--output")
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+        else if (arg == "--preset")
+        {
+            juce::MemoryBlock state;
+            const auto presetFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+
+            if (!presetFile.loadFileAsData(state))
+                return fail("can't read preset " + presetFile.getFullPathName());
+
+            stateProcessor.setStateInformation(state.getData(), (int)state.getSize());
+        }
+        else if (arg == "--set")
+        {
+            auto result = applyParameter(stateProcessor, nextValue());
+
+            if (result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if (arg == "--file-list")
+        {
+            auto result = addFileList(files, juce::File::getCurrentWorkingDirectory().getChildFile(nextValue()));
+
+            if (result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if (arg == "--threads")
+            settings.numThreads = nextValue().getIntValue();
+        else if (arg == "--block-size")
+            settings.blockSize = nextValue().getIntValue();
+        else if (arg == "--chunk-seconds")
+            settings.chunkSeconds = juce::jmax(0.1, nextValue().getDoubleValue());
+        else if (arg == "--verify")
+            settings.verify = true;
+        else if (arg == "--overwrite")
+            settings.overwrite = true;
+        else if (arg == "--save-preset")
+            savePresetFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+        else if (arg.isLongOption() || arg.isShortOption())
+            return fail("unknown option " + arg.text);
+        else
+            files.add(arg.resolveAsFile());
+    }
+
+    stateProcessor.getStateInformation(settings.state);
+
+    if (savePresetFile != juce::File() && !savePresetFile.replaceWithData(settings.state.getData(), settings.state.getSize()))
+    {
+        std::cerr << "can't write preset " << savePresetFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (files.isEmpty())
+        return savePresetFile != juce::File() ? 0 : (printUsage(), 1);
+
+    if (settings.outputDirectory == juce::File() || !settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "--output must name a directory that can be created" << std::endl;
+        return 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    OfflineRenderer renderer(formatManager, std::move(settings));
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const auto failures = renderer.renderFiles(files);
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    std::cout << files.size() - failures << " of " << files.size() << " files rendered in "
+              << seconds << " s" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
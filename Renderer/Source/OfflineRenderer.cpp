@@ -0,0 +1,538 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Applies a SimpleEQ state to audio files without a host.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+struct OfflineRenderer::Worker : juce::ThreadPoolJob
+{
+    Worker(OfflineRenderer& ownerToUse, SimpleEQAudioProcessor& processorToUse,
+           const juce::Array<juce::File>& filesToRender, std::atomic<int>& nextIndexToUse, std::atomic<int>& failuresToUse) :
+        juce::ThreadPoolJob("SimpleEQ render worker"),
+        owner(ownerToUse),
+        processor(processorToUse),
+        files(filesToRender),
+        nextIndex(nextIndexToUse),
+        failures(failuresToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        juce::AudioBuffer<float> scratch;
+
+        for (auto index = nextIndex++; index < files.size(); index = nextIndex++)
+        {
+            if (shouldExit())
+                break;
+
+            const auto& input = files.getReference(index);
+            auto result = owner.renderFile(processor, input, scratch);
+
+            if (result.wasOk())
+                owner.log("rendered " + input.getFullPathName());
+            else
+            {
+                ++failures;
+                owner.log("FAILED " + input.getFullPathName() + ": " + result.getErrorMessage());
+            }
+        }
+
+        return jobHasFinished;
+    }
+
+    OfflineRenderer& owner;
+    SimpleEQAudioProcessor& processor;
+    const juce::Array<juce::File>& files;
+    std::atomic<int>& nextIndex;
+    std::atomic<int>& failures;
+};
+
+//==============================================================================
+//chunks of one file, handed from the chunk workers to the writing thread in order
+struct OfflineRenderer::ChunkQueue
+{
+    struct Slot
+    {
+        juce::AudioBuffer<float> buffer;
+        std::atomic<bool> ready{ false };
+    };
+
+    ChunkQueue(int numSlots, int numChannels, int chunkLengthToUse, juce::int64 totalLength, int preRollToUse, int latencyToUse) :
+        slots((size_t)numSlots),
+        chunkLength(chunkLengthToUse),
+        length(totalLength),
+        preRoll(preRollToUse),
+        latency(latencyToUse),
+        numChunks((int)((totalLength + chunkLengthToUse - 1) / chunkLengthToUse))
+    {
+        for (auto& slot : slots)
+            slot.buffer.setSize(numChannels, chunkLength);
+    }
+
+    Slot& getSlot(int chunk) { return slots[(size_t)chunk % slots.size()]; }
+
+    juce::int64 getStart(int chunk) const { return (juce::int64)chunk * chunkLength; }
+    int getLength(int chunk) const { return (int)juce::jmin((juce::int64)chunkLength, length - getStart(chunk)); }
+
+    std::vector<Slot> slots;
+    const int chunkLength;
+    const juce::int64 length;
+    const int preRoll;
+    //the processor's reported latency, chunks are read this far ahead so the output lines up with the input
+    const int latency;
+    const int numChunks;
+
+    std::atomic<int> nextChunk{ 0 };
+    //chunks below this index have been written and their slots can be reused
+    std::atomic<int> numWritten{ 0 };
+    std::atomic<bool> failed{ false };
+
+    juce::WaitableEvent chunkReady, slotFreed;
+};
+
+struct OfflineRenderer::ChunkWorker : juce::ThreadPoolJob
+{
+    ChunkWorker(const OfflineRenderer& ownerToUse, SimpleEQAudioProcessor& processorToUse,
+                std::unique_ptr<juce::AudioFormatReader> readerToUse, ChunkQueue& queueToUse) :
+        juce::ThreadPoolJob("SimpleEQ chunk worker"),
+        owner(ownerToUse),
+        processor(processorToUse),
+        reader(std::move(readerToUse)),
+        queue(queueToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        juce::AudioBuffer<float> scratch(queue.slots.front().buffer.getNumChannels(), owner.settings.blockSize);
+
+        for (auto chunk = queue.nextChunk++; chunk < queue.numChunks; chunk = queue.nextChunk++)
+        {
+            //don't run further ahead of the writer than there are slots
+            while (chunk >= queue.numWritten.load() + (int)queue.slots.size())
+            {
+                if (shouldExit() || queue.failed)
+                    return jobHasFinished;
+
+                queue.slotFreed.wait(20);
+            }
+
+            if (shouldExit() || queue.failed)
+                break;
+
+            if (!renderChunk(chunk, scratch))
+            {
+                queue.failed = true;
+                queue.chunkReady.signal();
+                break;
+            }
+
+            queue.getSlot(chunk).ready = true;
+            queue.chunkReady.signal();
+        }
+
+        return jobHasFinished;
+    }
+
+    bool renderChunk(int chunk, juce::AudioBuffer<float>& scratch)
+    {
+        const auto start = queue.getStart(chunk);
+        const auto preRollStart = juce::jmax((juce::int64)0, start - queue.preRoll);
+
+        processor.reset();
+
+        //warm the filter state up on the audio before the chunk, output discarded
+        if (!process(scratch, preRollStart, (int)(start + queue.latency - preRollStart), true))
+            return false;
+
+        return process(queue.getSlot(chunk).buffer, start + queue.latency, queue.getLength(chunk), false);
+    }
+
+    //reads and processes numSamples from position into destination, or block by block
+    //over the start of destination when the output isn't needed
+    bool process(juce::AudioBuffer<float>& destination, juce::int64 position, int numSamples, bool reuseStart)
+    {
+        const auto blockSize = owner.settings.blockSize;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const auto n = juce::jmin(blockSize, numSamples - done);
+            const auto offset = reuseStart ? 0 : done;
+
+            juce::AudioBuffer<float> block(destination.getArrayOfWritePointers(), destination.getNumChannels(), offset, n);
+
+            if (!reader->read(&block, 0, n, position + done, true, true))
+                return false;
+
+            processor.processBlock(block, midi);
+            done += n;
+        }
+
+        return true;
+    }
+
+    const OfflineRenderer& owner;
+    SimpleEQAudioProcessor& processor;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    ChunkQueue& queue;
+    juce::MidiBuffer midi;
+};
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(juce::AudioFormatManager& formatManagerToUse, RenderSettings settingsToUse) :
+    formatManager(formatManagerToUse),
+    settings(std::move(settingsToUse))
+{
+    settings.numThreads = juce::jmax(1, settings.numThreads);
+    settings.blockSize = juce::jmax(1, settings.blockSize);
+}
+
+int OfflineRenderer::renderFiles(const juce::Array<juce::File>& files)
+{
+    std::atomic<int> nextIndex{ 0 };
+    std::atomic<int> failures{ 0 };
+
+    //too few files to keep every thread busy, split each one instead
+    const auto renderInChunks = files.size() < settings.numThreads;
+    const auto numWorkers = renderInChunks ? settings.numThreads : juce::jmin(settings.numThreads, files.size());
+
+    //processors are created and destroyed here on the main thread, each worker gets its own
+    std::vector<std::unique_ptr<SimpleEQAudioProcessor>> processors;
+
+    for (int i = 0; i < numWorkers; ++i)
+        processors.push_back(createProcessor());
+
+    if (renderInChunks)
+    {
+        for (auto& input : files)
+        {
+            auto result = renderFileInChunks(processors, input);
+
+            if (result.wasOk())
+                log("rendered " + input.getFullPathName());
+            else
+            {
+                ++failures;
+                log("FAILED " + input.getFullPathName() + ": " + result.getErrorMessage());
+            }
+        }
+
+        return failures.load();
+    }
+
+    juce::OwnedArray<Worker> workers;
+
+    for (auto& processor : processors)
+        workers.add(new Worker(*this, *processor, files, nextIndex, failures));
+
+    {
+        juce::ThreadPool pool(juce::jmax(1, numWorkers));
+
+        for (auto* worker : workers)
+            pool.addJob(worker, false);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(50);
+    }
+
+    return failures.load();
+}
+
+juce::Result OfflineRenderer::renderFile(SimpleEQAudioProcessor& processor, const juce::File& input,
+                                         juce::AudioBuffer<float>& scratch) const
+{
+    return renderFileTo(processor, input, getOutputFileFor(input), scratch);
+}
+
+juce::Result OfflineRenderer::renderFileTo(SimpleEQAudioProcessor& processor, const juce::File& input, const juce::File& output,
+                                           juce::AudioBuffer<float>& scratch) const
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr)
+        return juce::Result::fail("unsupported or unreadable file");
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    auto result = createWriter(input, output, *reader, writer);
+
+    if (result.failed())
+        return result;
+
+    const auto numChannels = (int)reader->numChannels;
+
+    if (!prepareProcessor(processor, numChannels, reader->sampleRate))
+        return juce::Result::fail("channel layout not supported");
+
+    scratch.setSize(numChannels, settings.blockSize, false, false, true);
+    juce::MidiBuffer midi;
+
+    //run on past the end of the file by the latency, reads there return silence
+    const auto latency = processor.getLatencySamples();
+    const auto endPosition = reader->lengthInSamples + latency;
+
+    for (juce::int64 position = 0; position < endPosition;)
+    {
+        const auto numSamples = (int)juce::jmin((juce::int64)settings.blockSize, endPosition - position);
+
+        //a view of the scratch buffer sized to this block, no reallocation
+        juce::AudioBuffer<float> block(scratch.getArrayOfWritePointers(), numChannels, numSamples);
+
+        if (!reader->read(&block, 0, numSamples, position, true, true))
+            return juce::Result::fail("read error");
+
+        processor.processBlock(block, midi);
+
+        //the first latency samples out are the processor's delay, not the file
+        const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+
+        if (skip < numSamples && !writer->writeFromAudioSampleBuffer(block, skip, numSamples - skip))
+            return juce::Result::fail("write error");
+
+        position += numSamples;
+    }
+
+    processor.releaseResources();
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::renderFileInChunks(const std::vector<std::unique_ptr<SimpleEQAudioProcessor>>& processors,
+                                                 const juce::File& input) const
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr)
+        return juce::Result::fail("unsupported or unreadable file");
+
+    const auto sampleRate = reader->sampleRate;
+    const auto numChannels = (int)reader->numChannels;
+    const auto chunkLength = juce::jmax(settings.blockSize, juce::roundToInt(settings.chunkSeconds * sampleRate));
+
+    //not worth splitting
+    if (reader->lengthInSamples < 2 * (juce::int64)chunkLength || processors.size() < 2)
+    {
+        juce::AudioBuffer<float> scratch;
+        auto result = renderFile(*processors.front(), input, scratch);
+
+        return result.failed() || !settings.verify ? result
+                                                   : verifyAgainstSerial(*processors.front(), input, getOutputFileFor(input));
+    }
+
+    for (auto& processor : processors)
+        if (!prepareProcessor(*processor, numChannels, sampleRate))
+            return juce::Result::fail("channel layout not supported");
+
+    //every processor holds the same state, so any of them gives the chain's coefficients
+    auto& first = *processors.front();
+    ChainCoefficients chainCoefficients;
+    makeChainCoefficients(chainCoefficients, getChainSettings(first.apvts), sampleRate);
+
+    //in linear-phase mode the FIR's length, not the cascade's decay, is what has to be warmed up
+    auto preRoll = juce::jmax(getDecayLengthInSamples(chainCoefficients, decayThreshold),
+                              (int)std::ceil(first.getTailLengthSeconds() * sampleRate));
+
+    if (preRoll > chunkLength)
+    {
+        log("warning: the filters take " + juce::String(preRoll) + " samples to settle, pre-roll is limited to the chunk length; "
+            "use a longer --chunk-seconds to keep chunk boundaries exact");
+        preRoll = chunkLength;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    auto result = createWriter(input, getOutputFileFor(input), *reader, writer);
+
+    if (result.failed())
+        return result;
+
+    //two chunks in flight per worker keeps everyone busy while the writer catches up
+    ChunkQueue queue((int)processors.size() * 2, numChannels, chunkLength, reader->lengthInSamples, preRoll,
+                     first.getLatencySamples());
+    juce::OwnedArray<ChunkWorker> workers;
+
+    for (auto& processor : processors)
+    {
+        //readers keep a read position, so each worker opens its own
+        std::unique_ptr<juce::AudioFormatReader> workerReader(formatManager.createReaderFor(input));
+
+        if (workerReader == nullptr)
+            return juce::Result::fail("can't reopen the input");
+
+        workers.add(new ChunkWorker(*this, *processor, std::move(workerReader), queue));
+    }
+
+    {
+        juce::ThreadPool pool((int)processors.size());
+
+        for (auto* worker : workers)
+            pool.addJob(worker, false);
+
+        //write chunks back in order as they complete
+        for (int chunk = 0; chunk < queue.numChunks && !queue.failed; ++chunk)
+        {
+            auto& slot = queue.getSlot(chunk);
+
+            while (!slot.ready && !queue.failed)
+                queue.chunkReady.wait(20);
+
+            if (queue.failed)
+                break;
+
+            if (!writer->writeFromAudioSampleBuffer(slot.buffer, 0, queue.getLength(chunk)))
+                queue.failed = true;
+
+            slot.ready = false;
+            ++queue.numWritten;
+            queue.slotFreed.signal();
+        }
+
+        //wakes any worker still waiting for a slot
+        queue.slotFreed.signal();
+        pool.removeAllJobs(true, 10000);
+    }
+
+    for (auto& processor : processors)
+        processor->releaseResources();
+
+    writer.reset();
+
+    if (queue.failed)
+        return juce::Result::fail("read or write error");
+
+    return settings.verify ? verifyAgainstSerial(*processors.front(), input, getOutputFileFor(input))
+                           : juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::verifyAgainstSerial(SimpleEQAudioProcessor& processor, const juce::File& input,
+                                                  const juce::File& rendered) const
+{
+    //a serial render through the same writer, so both sides see the same quantisation
+    juce::TemporaryFile serial(rendered);
+    juce::AudioBuffer<float> scratch;
+
+    auto result = renderFileTo(processor, input, serial.getFile(), scratch);
+
+    if (result.failed())
+        return juce::Result::fail("verify: " + result.getErrorMessage());
+
+    std::unique_ptr<juce::AudioFormatReader> expected(formatManager.createReaderFor(serial.getFile()));
+    std::unique_ptr<juce::AudioFormatReader> actual(formatManager.createReaderFor(rendered));
+
+    if (expected == nullptr || actual == nullptr)
+        return juce::Result::fail("verify: can't read the rendered files back");
+
+    if (expected->lengthInSamples != actual->lengthInSamples || expected->numChannels != actual->numChannels)
+        return juce::Result::fail("verify: chunked and serial renders differ in length or channel count");
+
+    const auto numChannels = (int)expected->numChannels;
+    juce::AudioBuffer<float> expectedBlock(numChannels, settings.blockSize), actualBlock(numChannels, settings.blockSize);
+    auto maxError = 0.0f;
+
+    for (juce::int64 position = 0; position < expected->lengthInSamples; position += settings.blockSize)
+    {
+        const auto n = (int)juce::jmin((juce::int64)settings.blockSize, expected->lengthInSamples - position);
+
+        if (!expected->read(&expectedBlock, 0, n, position, true, true) || !actual->read(&actualBlock, 0, n, position, true, true))
+            return juce::Result::fail("verify: read error");
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* e = expectedBlock.getReadPointer(channel);
+            auto* a = actualBlock.getReadPointer(channel);
+
+            for (int i = 0; i < n; ++i)
+                maxError = juce::jmax(maxError, std::abs(e[i] - a[i]));
+        }
+    }
+
+    //rounding either side of an integer step can flip one LSB
+    const auto lsb = expected->usesFloatingPointData ? 0.0 : std::ldexp(1.0, 1 - (int)expected->bitsPerSample);
+    const auto bound = verifyTolerance + lsb;
+
+    log("verify " + rendered.getFileName() + ": max difference from serial render "
+        + juce::String(juce::Decibels::gainToDecibels(maxError, -200.0f), 1) + " dBFS, bound "
+        + juce::String(juce::Decibels::gainToDecibels(bound, -200.0), 1) + " dBFS");
+
+    if (maxError > bound)
+        return juce::Result::fail("verify: chunked render differs from the serial render by more than the bound");
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::createWriter(const juce::File& input, const juce::File& output, const juce::AudioFormatReader& reader,
+                                           std::unique_ptr<juce::AudioFormatWriter>& writer) const
+{
+    auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+
+    if (format == nullptr)
+        return juce::Result::fail("no writer for " + input.getFileExtension());
+
+    if (output == input)
+        return juce::Result::fail("output would overwrite the input");
+
+    if (output.exists() && !settings.overwrite)
+        return juce::Result::fail(output.getFullPathName() + " already exists");
+
+    output.deleteFile();
+
+    std::unique_ptr<juce::FileOutputStream> stream(output.createOutputStream());
+
+    if (stream == nullptr)
+        return juce::Result::fail("can't write " + output.getFullPathName());
+
+    writer.reset(format->createWriterFor(stream.get(), reader.sampleRate, reader.numChannels,
+                                         (int)reader.bitsPerSample, reader.metadataValues, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail("the format can't write this channel count or bit depth");
+
+    //the writer owns the stream now
+    stream.release();
+
+    return juce::Result::ok();
+}
+
+juce::File OfflineRenderer::getOutputFileFor(const juce::File& input) const
+{
+    return settings.outputDirectory.getChildFile(input.getFileName());
+}
+
+std::unique_ptr<SimpleEQAudioProcessor> OfflineRenderer::createProcessor() const
+{
+    auto processor = std::make_unique<SimpleEQAudioProcessor>();
+
+    if (settings.state.getSize() > 0)
+        processor->setStateInformation(settings.state.getData(), (int)settings.state.getSize());
+
+    processor->setNonRealtime(true);
+
+    return processor;
+}
+
+bool OfflineRenderer::prepareProcessor(SimpleEQAudioProcessor& processor, int numChannels, double sampleRate) const
+{
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+
+    if (!processor.setBusesLayout(layout))
+        return false;
+
+    //also clears the filter state left over from the previous file
+    processor.prepareToPlay(sampleRate, settings.blockSize);
+
+    return true;
+}
+
+void OfflineRenderer::log(const juce::String& message) const
+{
+    const juce::ScopedLock sl(logLock);
+    std::cout << message << std::endl;
+}
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Applies a SimpleEQ state to audio files without a host.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../../Source/PluginProcessor.h"
+
+struct RenderSettings
+{
+    //a blob from getStateInformation, applied to every worker's processor
+    juce::MemoryBlock state;
+
+    juce::File outputDirectory;
+    int numThreads{ juce::SystemStats::getNumCpus() };
+    //samples read, processed and written per step, memory use does not grow with file length
+    int blockSize{ 8192 };
+    bool overwrite{ false };
+
+    //when there are fewer files than threads, each file is split into chunks of
+    //this length that render concurrently
+    double chunkSeconds{ 10.0 };
+    //also render chunked files serially and check the difference stays within the bound
+    bool verify{ false };
+};
+
+/**
+    Renders a list of files through SimpleEQAudioProcessor on a thread pool.
+
+    Every worker owns one processor and one scratch buffer and pulls the next
+    file from a shared index, so a worker that lands a long file does not hold
+    up the others. Files are streamed block by block from an AudioFormatReader
+    to an AudioFormatWriter of the same format, sample rate, channel count and
+    bit depth.
+
+    With fewer files than threads, files are instead rendered one at a time,
+    split into chunks that every worker renders concurrently. Each chunk first
+    runs the chain over a pre-roll of the preceding audio, long enough for the
+    cascade's impulse response to decay below decayThreshold, so its filter
+    state has converged to what a serial render would have by the time its
+    output starts. Chunks are written in order through a bounded window.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer(juce::AudioFormatManager& formatManagerToUse, RenderSettings settingsToUse);
+
+    //how far the chain's impulse response must decay over a chunk's pre-roll
+    static constexpr double decayThreshold = 1.0e-7;
+    //largest difference from a serial render --verify accepts, on top of one LSB for integer formats
+    static constexpr double verifyTolerance = 1.0e-5;
+
+    //returns the number of files that failed
+    int renderFiles(const juce::Array<juce::File>& files);
+
+    //renders one file with an existing processor, used by the workers
+    juce::Result renderFile(SimpleEQAudioProcessor& processor, const juce::File& input,
+                            juce::AudioBuffer<float>& scratch) const;
+
+    //renders one file split into chunks, one processor per concurrent chunk
+    juce::Result renderFileInChunks(const std::vector<std::unique_ptr<SimpleEQAudioProcessor>>& processors,
+                                    const juce::File& input) const;
+
+    juce::File getOutputFileFor(const juce::File& input) const;
+
+private:
+    struct Worker;
+    struct ChunkQueue;
+    struct ChunkWorker;
+
+    juce::Result renderFileTo(SimpleEQAudioProcessor& processor, const juce::File& input, const juce::File& output,
+                              juce::AudioBuffer<float>& scratch) const;
+    juce::Result createWriter(const juce::File& input, const juce::File& output, const juce::AudioFormatReader& reader,
+                              std::unique_ptr<juce::AudioFormatWriter>& writer) const;
+    juce::Result verifyAgainstSerial(SimpleEQAudioProcessor& processor, const juce::File& input, const juce::File& rendered) const;
+
+    std::unique_ptr<SimpleEQAudioProcessor> createProcessor() const;
+    bool prepareProcessor(SimpleEQAudioProcessor& processor, int numChannels, double sampleRate) const;
+    void log(const juce::String& message) const;
+
+    juce::AudioFormatManager& formatManager;
+    RenderSettings settings;
+
+    juce::CriticalSection logLock;
+
+    JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    AnalyzerFifo.h
+    Wait-free single-producer/single-consumer ring of preallocated sample
+    blocks, from the audio thread to the analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+    NumBlocks blocks of BlockSize mono samples.
+
+    The audio thread push()es any number of samples of any channel count; they
+    are mixed down to mono into the block being filled, which is published
+    once full. The consumer pop()s whole blocks. All storage is inline, and
+    neither side ever locks, allocates or waits. When the consumer falls
+    behind, the producer drops the block it was filling and counts it instead
+    of overwriting blocks the consumer may be reading.
+*/
+template<int BlockSize, int NumBlocks>
+class AnalyzerFifo
+{
+public:
+    using Block = std::array<float, (std::size_t)BlockSize>;
+
+    //producer side
+    void push(const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (numChannels <= 0)
+            return;
+
+        const auto gain = 1.f / (float)numChannels;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const auto n = std::min(numSamples - done, BlockSize - fill);
+            auto* destination = blocks[(std::size_t)(written % NumBlocks)].data() + fill;
+
+            for (int i = 0; i < n; ++i)
+            {
+                auto sum = channels[0][done + i];
+
+                for (int channel = 1; channel < numChannels; ++channel)
+                    sum += channels[channel][done + i];
+
+                destination[i] = sum * gain;
+            }
+
+            fill += n;
+            done += n;
+
+            if (fill == BlockSize)
+            {
+                fill = 0;
+
+                if (written - readCount.load(std::memory_order_acquire) < (std::uint32_t)NumBlocks - 1)
+                    writeCount.store(++written, std::memory_order_release);
+                else
+                    ++dropped; //full, refill the same block
+            }
+        }
+    }
+
+    //consumer side, returns false if no full block is waiting
+    bool pop(Block& destination) noexcept
+    {
+        const auto read = readCount.load(std::memory_order_relaxed);
+
+        if (read == writeCount.load(std::memory_order_acquire))
+            return false;
+
+        destination = blocks[(std::size_t)(read % NumBlocks)];
+        readCount.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    //consumer side, drops everything waiting
+    void clear() noexcept { readCount.store(writeCount.load(std::memory_order_acquire), std::memory_order_release); }
+
+    std::uint32_t getNumDropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::array<Block, (std::size_t)NumBlocks> blocks{};
+
+    //producer only
+    std::uint32_t written{ 0 };
+    int fill{ 0 };
+
+    std::atomic<std::uint32_t> writeCount{ 0 }, readCount{ 0 };
+    std::atomic<std::uint32_t> dropped{ 0 };
+};
@@ -0,0 +1,517 @@
+/*
+  ==============================================================================
+
+    CascadeEngine.cpp
+    Runs the LowCut, Peak and HighCut sections for every channel in one pass,
+    with each channel in its own SIMD lane.
+
+  ==============================================================================
+*/
+
+#include "CascadeEngine.h"
+
+namespace
+{
+   #if JUCE_USE_SIMD
+    template<typename SampleType>
+    struct LaneTraits
+    {
+        using Sample = SampleType;
+        using Vec = juce::dsp::SIMDRegister<SampleType>;
+        static constexpr int numLanes = (int)Vec::SIMDNumElements;
+
+        static Vec load(const SampleType* p) noexcept { return Vec::fromRawArray(p); }
+        static void store(SampleType* p, Vec v) noexcept { v.copyToRawArray(p); }
+        static Vec expand(SampleType x) noexcept { return Vec::expand(x); }
+    };
+   #else
+    template<typename SampleType>
+    struct LaneTraits
+    {
+        using Sample = SampleType;
+        using Vec = SampleType;
+        static constexpr int numLanes = 1;
+
+        static Vec load(const SampleType* p) noexcept { return *p; }
+        static void store(SampleType* p, Vec v) noexcept { *p = v; }
+        static Vec expand(SampleType x) noexcept { return x; }
+    };
+   #endif
+
+    static_assert(LaneTraits<float>::numLanes == CascadeEngine<float>::numLanes, "Lane count mismatch");
+    static_assert(LaneTraits<double>::numLanes == CascadeEngine<double>::numLanes, "Lane count mismatch");
+
+    template<typename SampleType>
+    CascadeKernel::Section<SampleType> makeDirectForm(const BiquadCoefficients& coefficients, const SvfCoefficients& prototype) noexcept
+    {
+        //float keeps JUCE's own design, bit for bit; double would only inherit its rounding
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::ignoreUnused(prototype);
+            return CascadeKernel::normalise<float>(coefficients);
+        }
+        else
+        {
+            juce::ignoreUnused(coefficients);
+
+            //the bilinear transform would cancel the poles with the zeros only to rounding
+            if (::isIdentity(prototype))
+                return {};
+
+            return CascadeKernel::toDirectForm<SampleType>(prototype.g, prototype.k, prototype.m0, prototype.m1, prototype.m2);
+        }
+    }
+
+    //a float 0 dB bell from JUCE's designer normalises to within an ulp of this, and then has to run
+    template<typename SampleType>
+    bool isPassThrough(const CascadeKernel::Section<SampleType>& section) noexcept
+    {
+        return section.b0 == SampleType(1) && section.b1 == SampleType(0) && section.b2 == SampleType(0)
+            && section.a1 == SampleType(0) && section.a2 == SampleType(0);
+    }
+
+    template<typename SampleType>
+    CascadeKernel::SvfSection<SampleType> makeStateVariable(const SvfCoefficients& prototype) noexcept
+    {
+        return CascadeKernel::makeSvfSection(static_cast<SampleType>(prototype.g), static_cast<SampleType>(prototype.k),
+                                             static_cast<SampleType>(prototype.m0), static_cast<SampleType>(prototype.m1),
+                                             static_cast<SampleType>(prototype.m2));
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+template<int MaxOrder>
+void CascadeEngine<SampleType>::Band<MaxOrder>::prepare(double sampleRate, double rampLengthSeconds)
+{
+    directForm.prepare(sampleRate, rampLengthSeconds);
+    stateVariable.prepare(sampleRate, rampLengthSeconds);
+}
+
+template<typename SampleType>
+template<int MaxOrder>
+void CascadeEngine<SampleType>::Band<MaxOrder>::setTarget(const BiquadCoefficients* coefficients,
+                                                          const SvfCoefficients* prototypes, int order) noexcept
+{
+    //the order picks the Cascade specialisation, sections beyond it keep their state but never run
+    directForm.target.order = order;
+    stateVariable.target.order = order;
+    directFormIsIdentity = stateVariableIsIdentity = true;
+    idle = false;
+
+    for (int i = 0; i < order; ++i)
+    {
+        directForm.target.sections[(size_t)i] = makeDirectForm<SampleType>(coefficients[i], prototypes[i]);
+        stateVariable.target.sections[(size_t)i] = makeStateVariable<SampleType>(prototypes[i]);
+        directFormIsIdentity = directFormIsIdentity && isPassThrough(directForm.target.sections[(size_t)i]);
+        stateVariableIsIdentity = stateVariableIsIdentity && ::isIdentity(prototypes[i]);
+    }
+
+    //both follow, so a topology switch starts from the current design
+    directForm.retarget();
+    stateVariable.retarget();
+
+    //a jump (new order, first target) replaces the sweep outright, a glide takes over where it ends
+    if (!stateVariable.isRamping())
+        sweeping = false;
+}
+
+template<typename SampleType>
+template<int MaxOrder>
+void CascadeEngine<SampleType>::Band<MaxOrder>::advance(int numSamples) noexcept
+{
+    if (!isStateVariable())
+    {
+        directForm.advance(numSamples);
+        return;
+    }
+
+    if (!stateVariable.isRamping())
+    {
+        sweeping = false;
+        return;
+    }
+
+    //live jumps to the end of the step, the sweep gets there one frame at a time
+    const auto from = stateVariable.live;
+    stateVariable.advance(numSamples);
+
+    sweep.order = from.order;
+
+    for (int i = 0; i < from.order; ++i)
+        sweep.sections[(size_t)i] = CascadeKernel::makeSweep(from.sections[(size_t)i], stateVariable.live.sections[(size_t)i], numSamples);
+
+    sweeping = true;
+}
+
+//==============================================================================
+template<typename SampleType>
+void CascadeEngine<SampleType>::prepare(int numChannels, double sampleRate)
+{
+    numChannelsPrepared = juce::jmax(0, numChannels);
+
+   #if SIMPLEEQ_KERNEL_DISPATCH
+    //the narrowest pass that covers every channel, or the widest the CPU has
+    auto groupsPerPass = 1;
+
+    while (groupsPerPass < variant.maxGroupsPerPass && groupsPerPass * numLanes < numChannelsPrepared)
+        groupsPerPass *= 2;
+
+    groupLanes = groupsPerPass * numLanes;
+    kernels = &variant.get<SampleType>(groupsPerPass);
+   #endif
+
+    //the only allocation, the audio thread never resizes it
+    groups.resize((size_t)((numChannelsPrepared + groupLanes - 1) / groupLanes));
+
+    lowCut.prepare(sampleRate, rampLengthSeconds);
+    peak.prepare(sampleRate, rampLengthSeconds);
+    highCut.prepare(sampleRate, rampLengthSeconds);
+    lowCut.sweeping = peak.sweeping = highCut.sweeping = false;
+    lowCut.idle = peak.idle = highCut.idle = false;
+    samplesToNextControlStep = 0;
+    samplesIntoControlStep = 0;
+
+    reset();
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setControlInterval(int numSamples)
+{
+    controlInterval = juce::jlimit(1, 4096, numSamples);
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setRampLength(double seconds)
+{
+    rampLengthSeconds = juce::jmax(0.0, seconds);
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setTopology(ChainPositions band, CascadeTopology topology)
+{
+    auto apply = [topology](auto& b)
+    {
+        b.topology = topology;
+        //the one that stopped following the ramp picks up where the other was heading
+        b.directForm.snapToTarget();
+        b.stateVariable.snapToTarget();
+        b.sweeping = false;
+        b.idle = false;
+    };
+
+    if (band == ChainPositions::LowCut)
+        apply(lowCut);
+    else if (band == ChainPositions::Peak)
+        apply(peak);
+    else
+        apply(highCut);
+}
+
+template<typename SampleType>
+CascadeTopology CascadeEngine<SampleType>::getTopology(ChainPositions band) const noexcept
+{
+    if (band == ChainPositions::LowCut)
+        return lowCut.topology;
+
+    return band == ChainPositions::Peak ? peak.topology : highCut.topology;
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::reset()
+{
+    for (auto& group : groups)
+        group = {};
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setLowCut(const CutCoefficients& coefficients, const CutSvfCoefficients& prototypes, Slope slope)
+{
+    setBandTarget(lowCut, &GroupState::lowCut, coefficients.data(), prototypes.data(), slope + 1);
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setPeak(const BiquadCoefficients& coefficients, const SvfCoefficients& prototype)
+{
+    setBandTarget(peak, &GroupState::peak, &coefficients, &prototype, 1);
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::setHighCut(const CutCoefficients& coefficients, const CutSvfCoefficients& prototypes, Slope slope)
+{
+    setBandTarget(highCut, &GroupState::highCut, coefficients.data(), prototypes.data(), slope + 1);
+}
+
+template<typename SampleType>
+template<int MaxOrder>
+void CascadeEngine<SampleType>::setBandTarget(Band<MaxOrder>& band, BandState<MaxOrder> state,
+                                              const BiquadCoefficients* coefficients, const SvfCoefficients* prototypes, int order) noexcept
+{
+    const auto wasIdle = band.idle;
+    band.setTarget(coefficients, prototypes, order);
+
+    //the frozen state is stale, an identity that had kept running would be at or near zero
+    if (wasIdle)
+        for (auto& group : groups)
+            group.*state = {};
+}
+
+template<typename SampleType>
+template<int MaxOrder>
+void CascadeEngine<SampleType>::updateIdle(Band<MaxOrder>& band, BandState<MaxOrder> state, int numChannels) noexcept
+{
+    if (band.idle || !band.isSettledIdentity())
+        return;
+
+    //a state-variable identity's output is m0 x whatever its state holds
+    if (band.isStateVariable())
+    {
+        band.idle = true;
+        return;
+    }
+
+    const auto numValues = band.getOrder() * 2 * groupLanes;
+
+    for (int g = 0; g * groupLanes < numChannels; ++g)
+    {
+        const auto& values = (groups[(size_t)g].*state).values;
+
+        for (int value = 0; value < numValues; ++value)
+            if (std::abs(values[(size_t)value]) > SampleType(idleThreshold))
+                return;
+    }
+
+    band.idle = true;
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const auto numChannels = juce::jmin((int)block.getNumChannels(), numChannelsPrepared);
+    bandsProcessed = 0;
+
+    if (numChannels == 0 || block.getNumSamples() == 0)
+        return;
+
+    //nothing but identities, or silence in and nothing left ringing: the block already is the output
+    if (!isRamping())
+    {
+        if (isIdle())
+        {
+            samplesToNextControlStep = 0;
+            return;
+        }
+
+        if (hasRungOut(numChannels))
+        {
+            const auto range = block.getSubsetChannelBlock(0, (size_t)numChannels).findMinAndMax();
+
+            if (range.getStart() == SampleType(0) && range.getEnd() == SampleType(0))
+            {
+                samplesToNextControlStep = 0;
+                return;
+            }
+        }
+    }
+
+    bandsProcessed = (int)!lowCut.idle + (int)!peak.idle + (int)!highCut.idle;
+
+    if (!isRamping())
+    {
+        //settled coefficients, the whole block in one go
+        samplesToNextControlStep = 0;
+        lowCut.sweeping = peak.sweeping = highCut.sweeping = false;
+        processSpan(block, numChannels, 0);
+    }
+    else
+    {
+        const auto numSamples = (int)block.getNumSamples();
+
+        for (int start = 0; start < numSamples;)
+        {
+            if (samplesToNextControlStep == 0)
+            {
+                lowCut.advance(controlInterval);
+                peak.advance(controlInterval);
+                highCut.advance(controlInterval);
+                samplesToNextControlStep = controlInterval;
+                samplesIntoControlStep = 0;
+            }
+
+            const auto numToProcess = juce::jmin(samplesToNextControlStep, numSamples - start);
+            processSpan(block.getSubBlock((size_t)start, (size_t)numToProcess), numChannels, samplesIntoControlStep);
+
+            samplesToNextControlStep -= numToProcess;
+            samplesIntoControlStep += numToProcess;
+            start += numToProcess;
+        }
+    }
+
+    snapStateToZero(numChannels);
+
+    updateIdle(lowCut, &GroupState::lowCut, numChannels);
+    updateIdle(peak, &GroupState::peak, numChannels);
+    updateIdle(highCut, &GroupState::highCut, numChannels);
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::processSpan(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int stepFrame) noexcept
+{
+    static constexpr auto blockFunctions = makeBlockFunctions(std::make_integer_sequence<int, maxCutOrder * maxCutOrder>());
+
+    //the only branch on the slopes, taken once per span
+    const auto index = (lowCut.getOrder() - 1) * maxCutOrder + (highCut.getOrder() - 1);
+    (this->*blockFunctions[(size_t)index])(block, numChannels, stepFrame);
+}
+
+template<typename SampleType>
+template<int Order, typename SectionType, int MaxOrder>
+void CascadeEngine<SampleType>::runCascade(const CascadeKernel::CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+                                           CascadeKernel::CascadeState<SampleType, MaxOrder, maxGroupLanes>& state,
+                                           SampleType* frames, int numFrames) const noexcept
+{
+   #if SIMPLEEQ_KERNEL_DISPATCH
+    //one indirect call per band and chunk into the variant for this CPU
+    kernels->template getBand<MaxOrder>().template get<SectionType>()[(size_t)(Order - 1)](coefficients, state, frames, numFrames);
+   #else
+    CascadeKernel::Cascade<LaneTraits<SampleType>, Order>::process(coefficients, state, frames, numFrames);
+   #endif
+}
+
+template<typename SampleType>
+template<int Order, int MaxOrder>
+void CascadeEngine<SampleType>::processBand(const Band<MaxOrder>& band, CascadeKernel::CascadeState<SampleType, MaxOrder, maxGroupLanes>& state,
+                                            SampleType* frames, int numFrames, int stepFrame) const noexcept
+{
+    //a branch per band and chunk, which always goes the same way
+    if (band.idle)
+        return;
+
+    if (!band.isStateVariable())
+    {
+        runCascade<Order>(band.directForm.live, state, frames, numFrames);
+    }
+    else if (!band.sweeping)
+    {
+        runCascade<Order>(band.stateVariable.live, state, frames, numFrames);
+    }
+    else
+    {
+        //every channel group starts from the same point of the sweep
+        CascadeKernel::CascadeCoefficients<CascadeKernel::SvfSweep<SampleType>, MaxOrder> sweep;
+        sweep.order = band.sweep.order;
+
+        for (int i = 0; i < Order; ++i)
+            sweep.sections[(size_t)i] = CascadeKernel::advance(band.sweep.sections[(size_t)i], stepFrame);
+
+        runCascade<Order>(sweep, state, frames, numFrames);
+    }
+}
+
+template<typename SampleType>
+template<int LowCutOrder, int HighCutOrder>
+void CascadeEngine<SampleType>::processBlockWith(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int stepFrame) noexcept
+{
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (int g = 0; g * groupLanes < numChannels; ++g)
+    {
+        auto& group = groups[(size_t)g];
+        const auto firstChannel = g * groupLanes;
+        const auto groupChannels = juce::jmin(groupLanes, numChannels - firstChannel);
+
+        auto processFrames = [&](SampleType* frames, int numFrames, int firstFrame)
+        {
+            processBand<LowCutOrder>(lowCut, group.lowCut, frames, numFrames, stepFrame + firstFrame);
+            processBand<1>(peak, group.peak, frames, numFrames, stepFrame + firstFrame);
+            processBand<HighCutOrder>(highCut, group.highCut, frames, numFrames, stepFrame + firstFrame);
+        };
+
+        if constexpr (numLanes == 1)
+        {
+            //a single lane needs no interleaving, run straight over the channel
+            processFrames(block.getChannelPointer((size_t)firstChannel), numSamples, 0);
+        }
+        else
+        {
+            //unused lanes stay silent
+            alignas(64) SampleType frames[chunkSize * maxGroupLanes];
+            std::fill_n(frames, chunkSize * groupLanes, SampleType(0));
+
+            for (int start = 0; start < numSamples; start += chunkSize)
+            {
+                const auto numFrames = juce::jmin(chunkSize, numSamples - start);
+
+                //interleave, one channel per lane
+                for (int lane = 0; lane < groupChannels; ++lane)
+                {
+                    const auto* source = block.getChannelPointer((size_t)(firstChannel + lane)) + start;
+
+                    for (int i = 0; i < numFrames; ++i)
+                        frames[i * groupLanes + lane] = source[i];
+                }
+
+                processFrames(frames, numFrames, start);
+
+                //de-interleave back into the block
+                for (int lane = 0; lane < groupChannels; ++lane)
+                {
+                    auto* destination = block.getChannelPointer((size_t)(firstChannel + lane)) + start;
+
+                    for (int i = 0; i < numFrames; ++i)
+                        destination[i] = frames[i * groupLanes + lane];
+                }
+            }
+        }
+    }
+}
+
+template<typename SampleType>
+void CascadeEngine<SampleType>::snapStateToZero(int numChannels) noexcept
+{
+    //same denormal protection Filter applies at the end of each block
+    for (int g = 0; g * groupLanes < numChannels; ++g)
+    {
+        auto& group = groups[(size_t)g];
+        const auto groupChannels = juce::jmin(groupLanes, numChannels - g * groupLanes);
+
+        auto snap = [this, groupChannels](auto& state, int order)
+        {
+            for (int value = 0; value < order * 2; ++value)
+                for (int lane = 0; lane < groupChannels; ++lane)
+                    juce::dsp::util::snapToZero(state.values[(size_t)(value * groupLanes + lane)]);
+        };
+
+        snap(group.lowCut, lowCut.getOrder());
+        snap(group.peak, 1);
+        snap(group.highCut, highCut.getOrder());
+    }
+}
+
+template<typename SampleType>
+bool CascadeEngine<SampleType>::hasRungOut(int numChannels) const noexcept
+{
+    for (int g = 0; g * groupLanes < numChannels; ++g)
+    {
+        const auto& group = groups[(size_t)g];
+
+        auto isZero = [this](const auto& state, int order)
+        {
+            for (int value = 0; value < order * 2 * groupLanes; ++value)
+                if (state.values[(size_t)value] != SampleType(0))
+                    return false;
+
+            return true;
+        };
+
+        if ((!lowCut.idle && !isZero(group.lowCut, lowCut.getOrder()))
+            || (!peak.idle && !isZero(group.peak, 1))
+            || (!highCut.idle && !isZero(group.highCut, highCut.getOrder())))
+            return false;
+    }
+
+    return true;
+}
+
+template class CascadeEngine<float>;
+template class CascadeEngine<double>;
@@ -0,0 +1,321 @@
+/*
+  ==============================================================================
+
+    CascadeEngine.h
+    Runs the LowCut, Peak and HighCut sections for every channel in one pass,
+    with each channel in its own SIMD lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "CascadeKernel.h"
+#include "FilterDesign.h"
+#include "KernelDispatch.h"
+
+//how a band's sections are realised
+enum class CascadeTopology
+{
+    //transposed direct form II, in float bit-identical to juce::dsp::IIR::Filter
+    directForm,
+    //TPT state-variable filter, quiet with poles close to z = 1 at high sample rates
+    stateVariable
+};
+
+/**
+    A band's live coefficients, gliding towards the last target on a control-rate grid.
+
+    Normalised biquads are blended linearly rather than redesigned. A blend of
+    two stable sections is itself stable, because the (a1, a2) stability
+    triangle is convex, so the ramp can never blow up; state-variable sections
+    blend g and k, which only need to stay positive. A change of order
+    (slope) can't be blended and switches immediately.
+*/
+template<typename SectionType, int MaxOrder>
+struct RampedCoefficients
+{
+    using Coefficients = CascadeKernel::CascadeCoefficients<SectionType, MaxOrder>;
+    using Sample = typename SectionType::Sample;
+
+    Coefficients live, start, target;
+
+    void prepare(double sampleRate, double rampLengthSeconds)
+    {
+        ramp.reset(sampleRate, rampLengthSeconds);
+        ramp.setCurrentAndTargetValue(1.f);
+        hasTarget = false;
+    }
+
+    //call after writing target, the first target after prepare() is applied immediately
+    void retarget() noexcept
+    {
+        if (!hasTarget || target.order != live.order)
+        {
+            live = target;
+            ramp.setCurrentAndTargetValue(1.f);
+            hasTarget = true;
+            return;
+        }
+
+        start = live;
+        ramp.setCurrentAndTargetValue(0.f);
+        ramp.setTargetValue(1.f);
+
+        //zero-length ramp
+        if (!ramp.isSmoothing())
+            live = target;
+    }
+
+    //skips whatever is left of the ramp
+    void snapToTarget() noexcept
+    {
+        if (!hasTarget)
+            return;
+
+        live = target;
+        ramp.setCurrentAndTargetValue(1.f);
+    }
+
+    bool isRamping() const noexcept { return ramp.isSmoothing(); }
+
+    //moves the live coefficients numSamples further along the ramp
+    void advance(int numSamples) noexcept
+    {
+        if (!ramp.isSmoothing())
+            return;
+
+        const auto alpha = static_cast<Sample>(ramp.skip(numSamples));
+
+        if (!ramp.isSmoothing())
+        {
+            live = target;
+            return;
+        }
+
+        for (int i = 0; i < live.order; ++i)
+            live.sections[(size_t)i] = CascadeKernel::interpolate(start.sections[(size_t)i], target.sections[(size_t)i], alpha);
+    }
+
+private:
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> ramp;
+    bool hasTarget{ false };
+};
+
+/**
+    The whole LowCut/Peak/HighCut chain for every channel.
+
+    Each band's coefficients and state live inline in cache-line aligned arrays.
+    process() looks at the two cut slopes once per block and jumps to the
+    processBlockWith<LowCutOrder, HighCutOrder> specialisation, whose inner loops
+    have fixed section counts and no bypass flags. Channels are packed one per
+    lane into groups of numLanes (4 floats or 2 doubles with SSE or NEON, twice
+    that with AVX), so any layout from mono to immersive runs through the same
+    engine; without SIMD support every group is a single channel processed in
+    place with the same kernel. In float, with every band in direct form, the
+    output is bit-identical to a chain of juce::dsp::IIR::Filter objects.
+
+    Built with SIMPLEEQ_KERNEL_DISPATCH, as the CMake build does, the kernels
+    aren't inlined here but come from KernelDispatch: compiled for SSE2, AVX2
+    and AVX-512 and picked for the CPU once, without fused multiply-adds, so
+    every machine renders the same samples. Layouts wider than a group run 2
+    or 4 adjacent groups per pass, in 256-bit vectors with AVX2 and 512-bit
+    with AVX-512; stereo in float stays in one 128-bit group everywhere.
+
+    SampleType is float or double. The float direct form runs the float
+    biquads, exactly as JUCE designs them; everything else is built from the
+    double-precision prototypes, so the double engine's coefficients aren't
+    limited by float design. Each band picks its topology separately.
+
+    New coefficients glide in over the ramp length. While any band is ramping
+    the block is split on a fixed grid of controlInterval samples, which
+    carries over between blocks, and the live coefficients move once per grid
+    step. Shorter intervals sound smoother and cost more; with no ramp in
+    progress the block is processed in one go. State-variable bands don't
+    step: across each grid step they sweep from the last live sections to the
+    next, retuned every sample, so fast automation of a state-variable band
+    glides without zipper noise whatever the control interval.
+
+    Work that can't change the output is skipped. A band whose sections are
+    all exact identities (a HighCut parked at Nyquist, a 0 dB bell except as
+    a float direct form, where JUCE's design normalises to within an ulp of
+    one and is run like IIR::Filter runs it) goes idle once it has settled:
+    straight away as a state-variable filter, whose output then doesn't
+    depend on its state, and as a direct form once the transient its state
+    still carries is below idleThreshold. A chain of nothing but idle bands
+    returns straight away, and so does a block of digital silence into a
+    chain whose state has already been snapped to zero, i.e. has decayed
+    below the denormal floor.
+*/
+template<typename SampleType>
+class CascadeEngine
+{
+public:
+    static constexpr int maxCutOrder = 4;
+
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = (int)Register::SIMDNumElements;
+   #else
+    static constexpr int numLanes = 1;
+   #endif
+
+    //lanes in the widest pass, the size every group's state is kept at
+   #if SIMPLEEQ_KERNEL_DISPATCH
+    static constexpr int maxGroupLanes = numLanes * CascadeKernel::maxGroupsPerPass;
+   #else
+    static constexpr int maxGroupLanes = numLanes;
+   #endif
+
+    //largest state a settled direct-form identity may drop when it goes idle, -120 dBFS
+    static constexpr double idleThreshold = 1.0e-6;
+
+    static constexpr int defaultControlInterval = 32;
+    static constexpr double defaultRampLengthSeconds = 0.02;
+
+    void prepare(int numChannels, double sampleRate);
+    void reset();
+
+    //samples between coefficient updates while ramping
+    void setControlInterval(int numSamples);
+    int getControlInterval() const noexcept { return controlInterval; }
+
+    //takes effect on the next prepare()
+    void setRampLength(double seconds);
+
+    //not while process() runs: the band's state means something else in the other topology, call reset() after
+    void setTopology(ChainPositions band, CascadeTopology topology);
+    CascadeTopology getTopology(ChainPositions band) const noexcept;
+
+    //the biquads and their prototypes, each topology and precision takes the form it runs best from
+    void setLowCut(const CutCoefficients& coefficients, const CutSvfCoefficients& prototypes, Slope slope);
+    void setPeak(const BiquadCoefficients& coefficients, const SvfCoefficients& prototype);
+    void setHighCut(const CutCoefficients& coefficients, const CutSvfCoefficients& prototypes, Slope slope);
+
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    //bands the last process() ran, 0 if it left the block as it was
+    int getNumBandsProcessed() const noexcept { return bandsProcessed; }
+
+private:
+    //frames interleaved per pass, small enough to stay in L1
+    static constexpr int chunkSize = 64;
+
+    //one band in both topologies, only the selected one runs and ramps
+    template<int MaxOrder>
+    struct Band
+    {
+        RampedCoefficients<CascadeKernel::Section<SampleType>, MaxOrder> directForm;
+        RampedCoefficients<CascadeKernel::SvfSection<SampleType>, MaxOrder> stateVariable;
+        CascadeTopology topology{ CascadeTopology::directForm };
+
+        //a state-variable band's way through the current grid step, from its first frame
+        CascadeKernel::CascadeCoefficients<CascadeKernel::SvfSweep<SampleType>, MaxOrder> sweep;
+        bool sweeping{ false };
+
+        //every section of the last target passes its input through unchanged in that topology, exactly,
+        //and once it has settled and its state is negligible the band isn't run
+        bool directFormIsIdentity{ false }, stateVariableIsIdentity{ false };
+        bool idle{ false };
+
+        void prepare(double sampleRate, double rampLengthSeconds);
+        void setTarget(const BiquadCoefficients* coefficients, const SvfCoefficients* prototypes, int order) noexcept;
+        void advance(int numSamples) noexcept;
+
+        bool isStateVariable() const noexcept { return topology == CascadeTopology::stateVariable; }
+        bool isRamping() const noexcept { return isStateVariable() ? stateVariable.isRamping() : directForm.isRamping(); }
+        int getOrder() const noexcept { return isStateVariable() ? stateVariable.live.order : directForm.live.order; }
+
+        bool isTargetIdentity() const noexcept { return isStateVariable() ? stateVariableIsIdentity : directFormIsIdentity; }
+        bool isSettledIdentity() const noexcept { return isTargetIdentity() && !isRamping() && !sweeping; }
+    };
+
+    //per-pass state for every band, groupLanes of its lanes in use
+    struct GroupState
+    {
+        CascadeKernel::CascadeState<SampleType, maxCutOrder, maxGroupLanes> lowCut;
+        CascadeKernel::CascadeState<SampleType, 1, maxGroupLanes> peak;
+        CascadeKernel::CascadeState<SampleType, maxCutOrder, maxGroupLanes> highCut;
+    };
+
+    //stepFrame is how far into the current grid step the block starts
+    template<int LowCutOrder, int HighCutOrder>
+    void processBlockWith(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int stepFrame) noexcept;
+
+    //runs Order sections of a band in whichever topology it uses, a sweep from stepFrame on
+    template<int Order, int MaxOrder>
+    void processBand(const Band<MaxOrder>& band, CascadeKernel::CascadeState<SampleType, MaxOrder, maxGroupLanes>& state,
+                     SampleType* frames, int numFrames, int stepFrame) const noexcept;
+
+    //the kernel for Order sections of SectionType, built for this CPU where the build dispatches
+    template<int Order, typename SectionType, int MaxOrder>
+    void runCascade(const CascadeKernel::CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+                    CascadeKernel::CascadeState<SampleType, MaxOrder, maxGroupLanes>& state,
+                    SampleType* frames, int numFrames) const noexcept;
+
+    using BlockFunction = void (CascadeEngine::*)(const juce::dsp::AudioBlock<SampleType>&, int, int) noexcept;
+
+    template<int... Index>
+    static constexpr std::array<BlockFunction, sizeof...(Index)> makeBlockFunctions(std::integer_sequence<int, Index...>)
+    {
+        return { &CascadeEngine::processBlockWith<Index / maxCutOrder + 1, Index % maxCutOrder + 1>... };
+    }
+
+    void processSpan(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int stepFrame) noexcept;
+    void snapStateToZero(int numChannels) noexcept;
+
+    template<int MaxOrder>
+    using BandState = CascadeKernel::CascadeState<SampleType, MaxOrder, maxGroupLanes> GroupState::*;
+
+    //a band that starts running again starts from silence, the state it froze with is stale
+    template<int MaxOrder>
+    void setBandTarget(Band<MaxOrder>& band, BandState<MaxOrder> state,
+                       const BiquadCoefficients* coefficients, const SvfCoefficients* prototypes, int order) noexcept;
+
+    template<int MaxOrder>
+    void updateIdle(Band<MaxOrder>& band, BandState<MaxOrder> state, int numChannels) noexcept;
+
+    bool isIdle() const noexcept { return lowCut.idle && peak.idle && highCut.idle; }
+    //whether every running band's state is exactly zero
+    bool hasRungOut(int numChannels) const noexcept;
+
+    bool isSweeping() const noexcept { return lowCut.sweeping || peak.sweeping || highCut.sweeping; }
+
+    //a sweep runs to the end of its grid step even after the ramp itself has finished
+    bool isRamping() const noexcept
+    {
+        return lowCut.isRamping() || peak.isRamping() || highCut.isRamping()
+            || (samplesToNextControlStep > 0 && isSweeping());
+    }
+
+    Band<maxCutOrder> lowCut;
+    Band<1> peak;
+    Band<maxCutOrder> highCut;
+
+    int controlInterval{ defaultControlInterval };
+    //samples left before the next grid step, and done since the last one
+    int samplesToNextControlStep{ 0 };
+    int samplesIntoControlStep{ 0 };
+    double rampLengthSeconds{ defaultRampLengthSeconds };
+
+    //lanes per pass, numLanes times the lane groups prepare() chose to run together
+    int groupLanes{ numLanes };
+
+    //one contiguous buffer, sized in prepare(): channel c lives in lane c % groupLanes of entry c / groupLanes
+    std::vector<GroupState> groups;
+
+    int numChannelsPrepared{ 0 };
+    int bandsProcessed{ 0 };
+
+   #if SIMPLEEQ_KERNEL_DISPATCH
+    static_assert(numLanes == CascadeKernel::dispatchedLanes<SampleType>, "The kernels are built for another lane count");
+    static_assert(maxGroupLanes == CascadeKernel::maxPassLanes<SampleType>, "The kernels are built for another pass width");
+    static_assert(maxCutOrder == CascadeKernel::maxDispatchedOrder, "The kernels are built for another slope range");
+
+    //the variant is picked once per process, on the thread that creates the first engine; the width in prepare()
+    const CascadeKernel::KernelVariant& variant{ CascadeKernel::getKernelVariant() };
+    const CascadeKernel::Kernels<SampleType>* kernels{ &variant.get<SampleType>(1) };
+   #endif
+};
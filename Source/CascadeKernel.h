@@ -0,0 +1,392 @@
+/*
+  ==============================================================================
+
+    CascadeKernel.h
+    Biquad and state-variable cascade kernel that runs one channel per SIMD lane.
+
+    Deliberately free of JUCE so it can be instantiated with any vector type:
+    juce::dsp::SIMDRegister, a plain float for the scalar fallback, or a
+    compiler vector type.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace CascadeKernel
+{
+
+//normalised biquad section, the same five values IIR::Coefficients stores
+template<typename SampleType>
+struct Section
+{
+    using Sample = SampleType;
+
+    SampleType b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+};
+
+//normalises raw {b0, b1, b2, a0, a1, a2} exactly like IIR::Coefficients does,
+//so that the kernel output is bit-identical to juce::dsp::IIR::Filter
+template<typename SampleType, typename RawCoefficients>
+Section<SampleType> normalise(const RawCoefficients& raw) noexcept
+{
+    const auto a0 = static_cast<SampleType>(raw[3]);
+    const auto a0Inv = a0 != SampleType(0) ? SampleType(1) / a0 : SampleType(0);
+
+    Section<SampleType> section;
+    section.b0 = static_cast<SampleType>(raw[0]) * a0Inv;
+    section.b1 = static_cast<SampleType>(raw[1]) * a0Inv;
+    section.b2 = static_cast<SampleType>(raw[2]) * a0Inv;
+    section.a1 = static_cast<SampleType>(raw[4]) * a0Inv;
+    section.a2 = static_cast<SampleType>(raw[5]) * a0Inv;
+    return section;
+}
+
+//linear blend between two sections, alpha = 0 gives a and alpha = 1 gives b
+template<typename SampleType>
+Section<SampleType> interpolate(const Section<SampleType>& a, const Section<SampleType>& b, SampleType alpha) noexcept
+{
+    Section<SampleType> section;
+    section.b0 = a.b0 + (b.b0 - a.b0) * alpha;
+    section.b1 = a.b1 + (b.b1 - a.b1) * alpha;
+    section.b2 = a.b2 + (b.b2 - a.b2) * alpha;
+    section.a1 = a.a1 + (b.a1 - a.a1) * alpha;
+    section.a2 = a.a2 + (b.a2 - a.a2) * alpha;
+    return section;
+}
+
+/**
+    A topology-preserving-transform state-variable section, after Simper.
+
+    It runs the analog prototype (m0 s^2 + (m0 k + m1) s + (m0 + m2)) / (s^2 + k s + 1),
+    prewarped with g = tan(pi f / fs), as two trapezoidal integrators. Unlike a
+    direct form, its states stay well scaled however close the poles get to
+    z = 1, which is what keeps a 20 Hz cut quiet at 384 kHz in single precision.
+
+    g, k and the output mix m0, m1, m2 are what gets blended while gliding: any
+    blend of positive g and k is again a stable filter. a1, a2 and a3 are
+    derived from them for the kernel.
+*/
+template<typename SampleType>
+struct SvfSection
+{
+    using Sample = SampleType;
+
+    SampleType g{ 1 }, k{ 1 }, m0{ 1 }, m1{ 0 }, m2{ 0 };
+    SampleType a1{ SampleType(0.5) }, a2{ SampleType(0.5) }, a3{ SampleType(0.5) };
+};
+
+template<typename SampleType>
+SvfSection<SampleType> makeSvfSection(SampleType g, SampleType k, SampleType m0, SampleType m1, SampleType m2) noexcept
+{
+    SvfSection<SampleType> section;
+    section.g = g;
+    section.k = k;
+    section.m0 = m0;
+    section.m1 = m1;
+    section.m2 = m2;
+    section.a1 = SampleType(1) / (SampleType(1) + g * (g + k));
+    section.a2 = g * section.a1;
+    section.a3 = g * section.a2;
+    return section;
+}
+
+//linear blend of the prototype, alpha = 0 gives a and alpha = 1 gives b
+template<typename SampleType>
+SvfSection<SampleType> interpolate(const SvfSection<SampleType>& a, const SvfSection<SampleType>& b, SampleType alpha) noexcept
+{
+    return makeSvfSection(a.g + (b.g - a.g) * alpha,
+                          a.k + (b.k - a.k) * alpha,
+                          a.m0 + (b.m0 - a.m0) * alpha,
+                          a.m1 + (b.m1 - a.m1) * alpha,
+                          a.m2 + (b.m2 - a.m2) * alpha);
+}
+
+/**
+    A state-variable section moving in a straight line, by one set of
+    increments per frame, starting from the section at the first frame.
+
+    Retuning a TPT section takes a few multiplies and one reciprocal, so the
+    sweep recomputes a1, a2 and a3 every frame: cutoff, damping and gain can
+    follow automation sample by sample where a biquad would need a redesign,
+    and the prototype never leaves the line between two stable sections.
+*/
+template<typename SampleType>
+struct SvfSweep
+{
+    using Sample = SampleType;
+
+    SvfSection<SampleType> from;
+    SampleType dg{ 0 }, dk{ 0 }, dm0{ 0 }, dm1{ 0 }, dm2{ 0 };
+};
+
+//the sweep that takes a to b in numFrames frames
+template<typename SampleType>
+SvfSweep<SampleType> makeSweep(const SvfSection<SampleType>& a, const SvfSection<SampleType>& b, int numFrames) noexcept
+{
+    const auto scale = SampleType(1) / static_cast<SampleType>(numFrames > 0 ? numFrames : 1);
+
+    SvfSweep<SampleType> sweep;
+    sweep.from = a;
+    sweep.dg = (b.g - a.g) * scale;
+    sweep.dk = (b.k - a.k) * scale;
+    sweep.dm0 = (b.m0 - a.m0) * scale;
+    sweep.dm1 = (b.m1 - a.m1) * scale;
+    sweep.dm2 = (b.m2 - a.m2) * scale;
+    return sweep;
+}
+
+//the same sweep numFrames frames further along
+template<typename SampleType>
+SvfSweep<SampleType> advance(const SvfSweep<SampleType>& sweep, int numFrames) noexcept
+{
+    const auto n = static_cast<SampleType>(numFrames);
+
+    auto moved = sweep;
+    moved.from = makeSvfSection(sweep.from.g + sweep.dg * n,
+                                sweep.from.k + sweep.dk * n,
+                                sweep.from.m0 + sweep.dm0 * n,
+                                sweep.from.m1 + sweep.dm1 * n,
+                                sweep.from.m2 + sweep.dm2 * n);
+    return moved;
+}
+
+//the bilinear transform of the same prototype as a normalised biquad, computed in SampleType throughout
+template<typename SampleType>
+Section<SampleType> toDirectForm(SampleType g, SampleType k, SampleType m0, SampleType m1, SampleType m2) noexcept
+{
+    //numerator n0 s^2 + n1 s + n2
+    const auto n0 = m0;
+    const auto n1 = m0 * k + m1;
+    const auto n2 = m0 + m2;
+
+    const auto gSquared = g * g;
+    const auto a0Inv = SampleType(1) / (SampleType(1) + k * g + gSquared);
+
+    Section<SampleType> section;
+    section.b0 = (n0 + n1 * g + n2 * gSquared) * a0Inv;
+    section.b1 = SampleType(2) * (n2 * gSquared - n0) * a0Inv;
+    section.b2 = (n0 - n1 * g + n2 * gSquared) * a0Inv;
+    section.a1 = SampleType(2) * (gSquared - SampleType(1)) * a0Inv;
+    section.a2 = (SampleType(1) - k * g + gSquared) * a0Inv;
+    return section;
+}
+
+/**
+    Runs one transposed direct form II section over numFrames frames.
+
+    frames holds Traits::numLanes interleaved channels per frame. s1 and s2 are
+    the section's two state registers, one lane per channel. The arithmetic is
+    ordered exactly like juce::dsp::IIR::Filter so every lane matches a scalar
+    Filter bit for bit.
+
+    Traits must provide Sample, Vec, numLanes, load(), store() and expand().
+*/
+template<typename Traits>
+inline void processSection(const Section<typename Traits::Sample>& c,
+                           typename Traits::Vec& s1, typename Traits::Vec& s2,
+                           typename Traits::Sample* frames, int numFrames) noexcept
+{
+    using Vec = typename Traits::Vec;
+
+    const Vec b0 = Traits::expand(c.b0);
+    const Vec b1 = Traits::expand(c.b1);
+    const Vec b2 = Traits::expand(c.b2);
+    const Vec a1 = Traits::expand(c.a1);
+    const Vec a2 = Traits::expand(c.a2);
+
+    Vec lv1 = s1;
+    Vec lv2 = s2;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        auto* frame = frames + i * Traits::numLanes;
+
+        const Vec input = Traits::load(frame);
+        const Vec output = (input * b0) + lv1;
+        Traits::store(frame, output);
+
+        lv1 = (input * b1) - (output * a1) + lv2;
+        lv2 = (input * b2) - (output * a2);
+    }
+
+    s1 = lv1;
+    s2 = lv2;
+}
+
+/**
+    Runs one state-variable section over numFrames frames, in the same layout
+    as the direct form: s1 and s2 hold the two integrator states.
+*/
+template<typename Traits>
+inline void processSection(const SvfSection<typename Traits::Sample>& c,
+                           typename Traits::Vec& s1, typename Traits::Vec& s2,
+                           typename Traits::Sample* frames, int numFrames) noexcept
+{
+    using Vec = typename Traits::Vec;
+
+    const Vec a1 = Traits::expand(c.a1);
+    const Vec a2 = Traits::expand(c.a2);
+    const Vec a3 = Traits::expand(c.a3);
+    const Vec m0 = Traits::expand(c.m0);
+    const Vec m1 = Traits::expand(c.m1);
+    const Vec m2 = Traits::expand(c.m2);
+
+    Vec ic1eq = s1;
+    Vec ic2eq = s2;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        auto* frame = frames + i * Traits::numLanes;
+
+        const Vec input = Traits::load(frame);
+        const Vec v3 = input - ic2eq;
+        const Vec v1 = (ic1eq * a1) + (v3 * a2);
+        const Vec v2 = ic2eq + (ic1eq * a2) + (v3 * a3);
+
+        ic1eq = (v1 + v1) - ic1eq;
+        ic2eq = (v2 + v2) - ic2eq;
+
+        Traits::store(frame, (input * m0) + (v1 * m1) + (v2 * m2));
+    }
+
+    s1 = ic1eq;
+    s2 = ic2eq;
+}
+
+/**
+    Runs one state-variable section over numFrames frames while it sweeps,
+    retuning it before every frame.
+
+    The retuning doesn't depend on the signal, so it runs ahead of the
+    recursion a tile of frames at a time, in a loop the compiler vectorises
+    as wide as the instruction set allows, whatever the lane count.
+*/
+template<typename Traits>
+inline void processSection(const SvfSweep<typename Traits::Sample>& c,
+                           typename Traits::Vec& s1, typename Traits::Vec& s2,
+                           typename Traits::Sample* frames, int numFrames) noexcept
+{
+    using Sample = typename Traits::Sample;
+
+    constexpr int tileSize = 16;
+
+    auto ic1eq = s1;
+    auto ic2eq = s2;
+
+    for (int start = 0; start < numFrames; start += tileSize)
+    {
+        const auto tileFrames = numFrames - start < tileSize ? numFrames - start : tileSize;
+
+        //the coefficients are the same in every lane, so they move as scalars, the whole tile at once
+        alignas(64) Sample a1[tileSize], a2[tileSize], a3[tileSize], m0[tileSize], m1[tileSize], m2[tileSize];
+
+        for (int i = 0; i < tileSize; ++i)
+        {
+            const auto n = static_cast<Sample>(start + i);
+            const auto g = c.from.g + c.dg * n;
+            const auto k = c.from.k + c.dk * n;
+
+            a1[i] = Sample(1) / (Sample(1) + g * (g + k));
+            a2[i] = g * a1[i];
+            a3[i] = g * a2[i];
+            m0[i] = c.from.m0 + c.dm0 * n;
+            m1[i] = c.from.m1 + c.dm1 * n;
+            m2[i] = c.from.m2 + c.dm2 * n;
+        }
+
+        auto* tile = frames + start * Traits::numLanes;
+
+        for (int i = 0; i < tileFrames; ++i)
+        {
+            auto* frame = tile + i * Traits::numLanes;
+
+            const auto input = Traits::load(frame);
+            const auto v3 = input - ic2eq;
+            const auto v1 = (ic1eq * Traits::expand(a1[i])) + (v3 * Traits::expand(a2[i]));
+            const auto v2 = ic2eq + (ic1eq * Traits::expand(a2[i])) + (v3 * Traits::expand(a3[i]));
+
+            ic1eq = (v1 + v1) - ic1eq;
+            ic2eq = (v2 + v2) - ic2eq;
+
+            Traits::store(frame, (input * Traits::expand(m0[i])) + (v1 * Traits::expand(m1[i])) + (v2 * Traits::expand(m2[i])));
+        }
+    }
+
+    s1 = ic1eq;
+    s2 = ic2eq;
+}
+
+//coefficients for up to MaxOrder sections of one band, of which the first order are run;
+//SectionType is a Section, an SvfSection or an SvfSweep and picks the kernel
+template<typename SectionType, int MaxOrder>
+struct CascadeCoefficients
+{
+    alignas(64) std::array<SectionType, MaxOrder> sections{};
+    int order{ MaxOrder };
+};
+
+//the band's state held inline: s1 and s2 for every section, one lane per channel; a kernel on
+//narrower vectors than NumLanes keeps its sections' state packed at the front
+template<typename SampleType, int MaxOrder, int NumLanes>
+struct CascadeState
+{
+    alignas(64) std::array<SampleType, MaxOrder * 2 * NumLanes> values{};
+};
+
+/**
+    Runs exactly Order sections of a band over a chunk of frames.
+
+    The section count is a compile-time constant, so the loop is fully unrolled
+    and has no bypass checks: the caller picks the specialisation once per block.
+*/
+template<typename Traits, int Order>
+struct Cascade
+{
+    using Sample = typename Traits::Sample;
+
+    template<typename SectionType, int MaxOrder, int StateLanes>
+    static void process(const CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+                        CascadeState<Sample, MaxOrder, StateLanes>& state,
+                        Sample* frames, int numFrames) noexcept
+    {
+        static_assert(Order >= 0 && Order <= MaxOrder, "Order exceeds the band's storage");
+        static_assert(StateLanes >= Traits::numLanes, "The state has fewer lanes than the vectors");
+
+        if constexpr (Order > 0)
+            processSections(coefficients, state, frames, numFrames, std::make_integer_sequence<int, Order>());
+        else
+            (void)coefficients, (void)state, (void)frames, (void)numFrames;
+    }
+
+private:
+    template<typename SectionType, int MaxOrder, int StateLanes, int... Index>
+    static void processSections(const CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+                                CascadeState<Sample, MaxOrder, StateLanes>& state,
+                                Sample* frames, int numFrames, std::integer_sequence<int, Index...>) noexcept
+    {
+        (processOne<Index>(coefficients, state, frames, numFrames), ...);
+    }
+
+    template<int Index, typename SectionType, int MaxOrder, int StateLanes>
+    static void processOne(const CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+                           CascadeState<Sample, MaxOrder, StateLanes>& state,
+                           Sample* frames, int numFrames) noexcept
+    {
+        auto* s = state.values.data() + Index * 2 * Traits::numLanes;
+
+        auto s1 = Traits::load(s);
+        auto s2 = Traits::load(s + Traits::numLanes);
+
+        processSection<Traits>(coefficients.sections[(std::size_t)Index], s1, s2, frames, numFrames);
+
+        Traits::store(s, s1);
+        Traits::store(s + Traits::numLanes, s2);
+    }
+};
+
+} // namespace CascadeKernel
@@ -0,0 +1,333 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Band designs and design tables shared by every SimpleEQ instance in the
+    process, looked up by what they were designed from.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+#include <cstring>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    juce::uint64 mix(juce::uint64 hash, juce::uint64 value) noexcept
+    {
+        //splitmix64's finaliser over the running hash
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 31);
+    }
+
+    juce::uint64 bitsOf(float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    juce::uint64 bitsOf(double value) noexcept
+    {
+        juce::uint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+//==============================================================================
+bool CoefficientCache::Key::operator==(const Key& other) const noexcept
+{
+    return band == other.band && slope == other.slope
+        && bitsOf(frequency) == bitsOf(other.frequency)
+        && bitsOf(quality) == bitsOf(other.quality)
+        && bitsOf(gainInDecibels) == bitsOf(other.gainInDecibels)
+        && bitsOf(sampleRate) == bitsOf(other.sampleRate);
+}
+
+juce::uint64 CoefficientCache::Key::hash() const noexcept
+{
+    auto hash = mix(0, (juce::uint64)band << 32 | (juce::uint32)slope);
+    hash = mix(hash, bitsOf(frequency) << 32 | bitsOf(quality));
+    hash = mix(hash, bitsOf(gainInDecibels));
+    return mix(hash, bitsOf(sampleRate));
+}
+
+//==============================================================================
+CoefficientCache::ReadScope::ReadScope(CoefficientCache& cacheToUse) noexcept : cache(cacheToUse)
+{
+    for (;;)
+    {
+        const auto current = cache.epoch.load();
+        parity = (int)(current & 1);
+        cache.readers[(size_t)parity].fetch_add(1);
+
+        //counted in before the epoch moved on, so a reclaim that moves it waits for us
+        if (cache.epoch.load() == current)
+            return;
+
+        cache.readers[(size_t)parity].fetch_sub(1);
+    }
+}
+
+CoefficientCache::ReadScope::~ReadScope()
+{
+    cache.readers[(size_t)parity].fetch_sub(1);
+}
+
+//==============================================================================
+CoefficientCache::CoefficientCache() = default;
+
+CoefficientCache::~CoefficientCache()
+{
+    //the last designer has gone, nothing reads any more
+    for (auto& slot : slots)
+        delete slot.load();
+
+    for (auto* entry = retired.load(); entry != nullptr;)
+        delete std::exchange(entry, entry->nextRetired);
+}
+
+std::shared_ptr<const DesignTables> CoefficientCache::getDesignTables(double sampleRate)
+{
+    const juce::ScopedLock sl(tablesLock);
+
+    for (auto& [rate, weakTables] : designTables)
+        if (rate == sampleRate)
+            if (auto tables = weakTables.lock())
+                return tables;
+
+    //rates nobody uses any more
+    designTables.erase(std::remove_if(designTables.begin(), designTables.end(),
+                                      [](const auto& pair) { return pair.second.expired(); }),
+                       designTables.end());
+
+    auto tables = std::make_shared<DesignTables>();
+    tables->prepare(sampleRate);
+    designTables.emplace_back(sampleRate, tables);
+
+    return tables;
+}
+
+void CoefficientCache::makeLowCut(CutCoefficients& biquads, CutSvfCoefficients& prototypes,
+                                  const ChainSettings& chainSettings, const DesignTables& tables)
+{
+    Key key;
+    key.band = ChainPositions::LowCut;
+    key.slope = chainSettings.lowCutSlope;
+    key.frequency = chainSettings.lowCutFreq;
+    key.sampleRate = tables.getSampleRate();
+
+    fetch(key,
+          [&](Entry& entry)
+          {
+              tables.makeLowCutCoefficients(entry.biquads, chainSettings);
+              tables.makeLowCutSvfCoefficients(entry.prototypes, chainSettings);
+          },
+          [&](const Entry& entry)
+          {
+              for (int i = 0; i <= chainSettings.lowCutSlope; ++i)
+              {
+                  biquads[(size_t)i] = entry.biquads[(size_t)i];
+                  prototypes[(size_t)i] = entry.prototypes[(size_t)i];
+              }
+          });
+}
+
+void CoefficientCache::makePeak(BiquadCoefficients& biquad, SvfCoefficients& prototype,
+                                const ChainSettings& chainSettings, const DesignTables& tables)
+{
+    Key key;
+    key.band = ChainPositions::Peak;
+    key.frequency = chainSettings.peakFreq;
+    key.quality = chainSettings.peakQuality;
+    key.gainInDecibels = chainSettings.peakGainInDecibels;
+    key.sampleRate = tables.getSampleRate();
+
+    fetch(key,
+          [&](Entry& entry)
+          {
+              entry.biquads[0] = tables.makePeakCoefficients(chainSettings);
+              entry.prototypes[0] = tables.makePeakSvfCoefficients(chainSettings);
+          },
+          [&](const Entry& entry)
+          {
+              biquad = entry.biquads[0];
+              prototype = entry.prototypes[0];
+          });
+}
+
+void CoefficientCache::makeHighCut(CutCoefficients& biquads, CutSvfCoefficients& prototypes,
+                                   const ChainSettings& chainSettings, const DesignTables& tables)
+{
+    Key key;
+    key.band = ChainPositions::HighCut;
+    key.slope = chainSettings.highCutSlope;
+    key.sampleRate = tables.getSampleRate();
+    key.frequency = isHighCutParked(chainSettings, key.sampleRate) ? (float)(key.sampleRate * 0.5) : chainSettings.highCutFreq;
+
+    fetch(key,
+          [&](Entry& entry)
+          {
+              tables.makeHighCutCoefficients(entry.biquads, chainSettings);
+              tables.makeHighCutSvfCoefficients(entry.prototypes, chainSettings);
+          },
+          [&](const Entry& entry)
+          {
+              for (int i = 0; i <= chainSettings.highCutSlope; ++i)
+              {
+                  biquads[(size_t)i] = entry.biquads[(size_t)i];
+                  prototypes[(size_t)i] = entry.prototypes[(size_t)i];
+              }
+          });
+}
+
+CoefficientCache::Statistics CoefficientCache::getStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.hits = hits.load(std::memory_order_relaxed);
+    statistics.misses = misses.load(std::memory_order_relaxed);
+    statistics.evictions = evictions.load(std::memory_order_relaxed);
+    statistics.numEntries = numEntries.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+//==============================================================================
+template<typename Design, typename CopyOut>
+void CoefficientCache::fetch(const Key& key, Design&& design, CopyOut&& copyOut)
+{
+    {
+        const ReadScope scope(*this);
+
+        if (auto* entry = find(key))
+        {
+            copyOut(*entry);
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    //designed outside the table, nobody else can see it until it's inserted
+    auto entry = std::make_unique<Entry>();
+    entry->key = key;
+    design(*entry);
+    copyOut(*entry);
+
+    insert(std::move(entry));
+
+    if (numRetired.load() >= reclaimThreshold)
+        reclaim();
+}
+
+CoefficientCache::Entry* CoefficientCache::find(const Key& key) noexcept
+{
+    auto* bucket = slots.data() + (size_t)(key.hash() % (juce::uint64)numBuckets) * numWays;
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        auto* entry = bucket[way].load(std::memory_order_acquire);
+
+        if (entry != nullptr && entry->key == key)
+        {
+            entry->lastUsed.store(clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void CoefficientCache::insert(std::unique_ptr<Entry> entry)
+{
+    const ReadScope scope(*this);
+
+    auto* bucket = slots.data() + (size_t)(entry->key.hash() % (juce::uint64)numBuckets) * numWays;
+    const auto now = clock.fetch_add(1, std::memory_order_relaxed);
+    entry->lastUsed.store(now, std::memory_order_relaxed);
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        Entry* expected = nullptr;
+
+        if (bucket[way].compare_exchange_strong(expected, entry.get(), std::memory_order_acq_rel))
+        {
+            entry.release();
+            numEntries.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    //a full bucket replaces the entry looked up longest ago
+    int oldestWay = 0;
+    juce::uint32 oldestAge = 0;
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        if (auto* candidate = bucket[way].load(std::memory_order_acquire))
+        {
+            const auto age = now - candidate->lastUsed.load(std::memory_order_relaxed);
+
+            if (age >= oldestAge)
+            {
+                oldestAge = age;
+                oldestWay = way;
+            }
+        }
+    }
+
+    auto* victim = bucket[oldestWay].load(std::memory_order_acquire);
+
+    //another designer changed the slot meanwhile: this design was still copied out, it just isn't kept
+    if (victim != nullptr && bucket[oldestWay].compare_exchange_strong(victim, entry.get(), std::memory_order_acq_rel))
+    {
+        entry.release();
+        retire(victim);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CoefficientCache::retire(Entry* entry) noexcept
+{
+    entry->nextRetired = retired.load();
+
+    while (!retired.compare_exchange_weak(entry->nextRetired, entry))
+    {
+    }
+
+    numRetired.fetch_add(1);
+}
+
+void CoefficientCache::reclaim()
+{
+    //one reclaim at a time, whoever loses leaves it to the winner or the next insert
+    if (reclaiming.exchange(true))
+        return;
+
+    //every entry on the list was unlinked before the epoch moves on below
+    auto* list = retired.exchange(nullptr);
+
+    if (list != nullptr)
+    {
+        //new lookups count themselves in under the other parity and can't find these entries;
+        //the ones still counted under this parity may have, and take a few hundred nanoseconds
+        const auto parity = (size_t)(epoch.fetch_add(1) & 1);
+
+        while (readers[parity].load() != 0)
+            std::this_thread::yield();
+
+        for (auto* entry = list; entry != nullptr;)
+        {
+            delete std::exchange(entry, entry->nextRetired);
+            numRetired.fetch_sub(1);
+        }
+    }
+
+    reclaiming.store(false);
+}
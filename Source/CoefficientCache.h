@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Band designs and design tables shared by every SimpleEQ instance in the
+    process, looked up by what they were designed from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "DesignTables.h"
+
+/**
+    A process-wide cache of band designs, so instances with the same settings
+    design each band once between them.
+
+    Hold it through a juce::SharedResourcePointer, like CurveRenderThread: it
+    exists while any CoefficientDesigner does. Each entry is one band's
+    biquads and prototypes, immutable once inserted and addressed by its
+    content: band, sample rate, and the frequency, Q, gain and slope that
+    band uses, compared bit for bit. A HighCut parked at Nyquist is the same
+    entry at any frequency, since it's pass-through sections either way.
+
+    Entries live in a fixed set-associative table of numBuckets buckets of
+    numWays slots each. Lookups and inserts are lock-free: a lookup scans one
+    bucket, and an insert claims an empty slot, or replaces the bucket's
+    least recently used entry, with a compare-and-swap. Callers copy out of
+    an entry rather than keep it. That way a replaced entry can be freed as
+    soon as every lookup that might still be reading it has finished; that
+    grace period is tracked with two reader counts, and the thread whose
+    insert pushes the number of replaced entries past reclaimThreshold waits
+    for it and frees them. Memory follows the number of distinct settings in
+    use, up to numBuckets * numWays entries, rather than the number of
+    instances.
+
+    Only the designer thread, the message thread and offline renders call
+    in. A real-time audio thread only ever sees the designer's copies
+    through its TripleBuffer, so an eviction, a free or a wait for the grace
+    period never happens on it.
+
+    The DesignTables for each sample rate are shared the same way, built by
+    the first designer to prepare at that rate and freed with the last one.
+*/
+class CoefficientCache
+{
+public:
+    static constexpr int numBuckets = 512;
+    static constexpr int numWays = 8;
+    static constexpr int reclaimThreshold = 64;
+
+    CoefficientCache();
+    ~CoefficientCache();
+
+    //message thread: the tables for a rate, shared with every other designer at that rate
+    std::shared_ptr<const DesignTables> getDesignTables(double sampleRate);
+
+    //designing threads: the band's design for these settings, copied from the cache or designed
+    //with the tables and added to it; cuts only write the sections their slope uses
+    void makeLowCut(CutCoefficients& biquads, CutSvfCoefficients& prototypes,
+                    const ChainSettings& chainSettings, const DesignTables& tables);
+    void makePeak(BiquadCoefficients& biquad, SvfCoefficients& prototype,
+                  const ChainSettings& chainSettings, const DesignTables& tables);
+    void makeHighCut(CutCoefficients& biquads, CutSvfCoefficients& prototypes,
+                     const ChainSettings& chainSettings, const DesignTables& tables);
+
+    struct Statistics
+    {
+        juce::int64 hits{ 0 }, misses{ 0 }, evictions{ 0 };
+        int numEntries{ 0 };
+    };
+
+    //any thread
+    Statistics getStatistics() const noexcept;
+
+private:
+    //everything a band design depends on, with the fields the band doesn't use left at zero
+    struct Key
+    {
+        int band{ 0 }, slope{ 0 };
+        float frequency{ 0.f }, quality{ 0.f }, gainInDecibels{ 0.f };
+        double sampleRate{ 0.0 };
+
+        bool operator==(const Key& other) const noexcept;
+        juce::uint64 hash() const noexcept;
+    };
+
+    struct Entry
+    {
+        Key key;
+        //the peak uses the first of each
+        CutCoefficients biquads{};
+        CutSvfCoefficients prototypes{};
+
+        //clock value at the last lookup, the oldest in a full bucket is replaced
+        std::atomic<juce::uint32> lastUsed{ 0 };
+        Entry* nextRetired{ nullptr };
+    };
+
+    //marks the calling thread as reading entries until it goes out of scope
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(CoefficientCache& cacheToUse) noexcept;
+        ~ReadScope();
+
+    private:
+        CoefficientCache& cache;
+        int parity;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+    template<typename Design, typename CopyOut>
+    void fetch(const Key& key, Design&& design, CopyOut&& copyOut);
+
+    //inside a ReadScope
+    Entry* find(const Key& key) noexcept;
+    void insert(std::unique_ptr<Entry> entry);
+    void retire(Entry* entry) noexcept;
+
+    //frees the retired entries once no lookup can still see them, outside any ReadScope
+    void reclaim();
+
+    std::array<std::atomic<Entry*>, (size_t)(numBuckets * numWays)> slots{};
+
+    //grace periods: readers count themselves in under the epoch's parity
+    std::atomic<juce::uint64> epoch{ 0 };
+    std::array<std::atomic<int>, 2> readers{};
+
+    //replaced entries waiting for a grace period, a stack only ever pushed onto or taken whole
+    std::atomic<Entry*> retired{ nullptr };
+    std::atomic<int> numRetired{ 0 };
+    std::atomic<bool> reclaiming{ false };
+
+    std::atomic<juce::uint32> clock{ 0 };
+    std::atomic<int> numEntries{ 0 };
+    std::atomic<juce::int64> hits{ 0 }, misses{ 0 }, evictions{ 0 };
+
+    //only taken in prepare(), by the message thread
+    juce::CriticalSection tablesLock;
+    std::vector<std::pair<double, std::weak_ptr<const DesignTables>>> designTables;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientCache)
+};
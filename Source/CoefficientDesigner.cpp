@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+    Turns parameter changes into complete ChainCoefficients sets for the
+    audio thread, on a background thread shared by every instance.
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+
+CoefficientDesignerThread::CoefficientDesignerThread() :
+    juce::Thread("SimpleEQ coefficient designer")
+{
+    startThread();
+}
+
+CoefficientDesignerThread::~CoefficientDesignerThread()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
+
+void CoefficientDesignerThread::add(CoefficientDesigner& designer)
+{
+    {
+        const juce::ScopedLock sl(designerLock);
+        designers.addIfNotAlreadyThere(&designer);
+    }
+
+    notify();
+}
+
+void CoefficientDesignerThread::remove(CoefficientDesigner& designer)
+{
+    const juce::ScopedLock sl(designerLock);
+    designers.removeFirstMatchingValue(&designer);
+}
+
+bool CoefficientDesignerThread::isIdle() const
+{
+    const juce::ScopedLock sl(designerLock);
+    return designers.isEmpty();
+}
+
+void CoefficientDesignerThread::run()
+{
+    while (!threadShouldExit())
+    {
+        //only add() and the destructor notify this thread, so dense automation coalesces into one
+        //design pass per designer per wake-up
+        wait(isIdle() ? -1 : pollIntervalMs);
+
+        if (threadShouldExit())
+            break;
+
+        const juce::ScopedLock sl(designerLock);
+
+        for (auto* designer : designers)
+            designer->designDirtyBands();
+    }
+}
+
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(ChainParameters& parametersToUse) :
+    parameters(parametersToUse)
+{
+    markAllDirty();
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    release();
+}
+
+void CoefficientDesigner::prepare(double newSampleRate)
+{
+    jassert(newSampleRate > 0.0);
+
+    {
+        const juce::ScopedLock sl(designLock);
+        //whatever was designed so far was for the old rate
+        hasDesignedSettings = false;
+        designTables = cache->getDesignTables(newSampleRate);
+        sampleRate.store(newSampleRate);
+    }
+
+    markAllDirty();
+    designDirtyBands();
+
+    designerThread->add(*this);
+}
+
+void CoefficientDesigner::release()
+{
+    designerThread->remove(*this);
+}
+
+void CoefficientDesigner::markDirty(ChainPositions band)
+{
+    bandDirty[(size_t)band].store(true);
+}
+
+void CoefficientDesigner::markAllDirty()
+{
+    for (auto& dirty : bandDirty)
+        dirty.store(true);
+}
+
+void CoefficientDesigner::requestRepublish()
+{
+    republishRequested.store(true);
+}
+
+bool CoefficientDesigner::designDirtyBands()
+{
+    const juce::ScopedLock sl(designLock);
+
+    if (sampleRate.load() <= 0.0)
+        return false;
+
+    //clear the flags before reading the parameters, so a change landing in between is never lost
+    auto lowCutDirty = bandDirty[ChainPositions::LowCut].exchange(false);
+    auto peakDirty = bandDirty[ChainPositions::Peak].exchange(false);
+    auto highCutDirty = bandDirty[ChainPositions::HighCut].exchange(false);
+    const auto republish = republishRequested.exchange(false);
+
+    if (!(lowCutDirty || peakDirty || highCutDirty || republish))
+        return false;
+
+    auto chainSettings = parameters.load();
+
+    if (hasDesignedSettings)
+    {
+        //a band can be marked dirty without its settings changing, e.g. after publishPrecomputed()
+        lowCutDirty = lowCutDirty && !isLowCutEqual(chainSettings, designedSettings);
+        peakDirty = peakDirty && !isPeakEqual(chainSettings, designedSettings);
+        highCutDirty = highCutDirty && !isHighCutEqual(chainSettings, designedSettings);
+
+        //a republish goes out even then, with the band versions unchanged so the audio thread reloads nothing
+        if (!(lowCutDirty || peakDirty || highCutDirty || republish))
+            return false;
+    }
+
+    if (lowCutDirty)
+    {
+        cache->makeLowCut(workingSet.lowCut, workingSet.lowCutSvf, chainSettings, *designTables);
+        workingSet.lowCutSlope = chainSettings.lowCutSlope;
+        ++workingSet.bandVersions[ChainPositions::LowCut];
+    }
+
+    if (peakDirty)
+    {
+        cache->makePeak(workingSet.peak, workingSet.peakSvf, chainSettings, *designTables);
+        ++workingSet.bandVersions[ChainPositions::Peak];
+    }
+
+    if (highCutDirty)
+    {
+        cache->makeHighCut(workingSet.highCut, workingSet.highCutSvf, chainSettings, *designTables);
+        workingSet.highCutSlope = chainSettings.highCutSlope;
+        ++workingSet.bandVersions[ChainPositions::HighCut];
+    }
+
+    designedSettings = chainSettings;
+    hasDesignedSettings = true;
+
+    publishWorkingSet();
+    return true;
+}
+
+void CoefficientDesigner::publishPrecomputed(const ChainCoefficients& chainCoefficients, const ChainSettings& settings)
+{
+    const juce::ScopedLock sl(designLock);
+
+    if (sampleRate.load() <= 0.0)
+        return;
+
+    //keep our own versions running, so the audio thread reloads every band
+    const auto versions = workingSet.bandVersions;
+    workingSet = chainCoefficients;
+    workingSet.bandVersions = versions;
+
+    //presets only store the biquads, the prototypes are cheap to redo from the tables
+    designTables->makeLowCutSvfCoefficients(workingSet.lowCutSvf, settings);
+    workingSet.peakSvf = designTables->makePeakSvfCoefficients(settings);
+    designTables->makeHighCutSvfCoefficients(workingSet.highCutSvf, settings);
+
+    for (auto& version : workingSet.bandVersions)
+        ++version;
+
+    designedSettings = settings;
+    hasDesignedSettings = true;
+
+    publishWorkingSet();
+}
+
+void CoefficientDesigner::publishWorkingSet()
+{
+    coefficients.getWriteBuffer() = workingSet;
+    coefficients.publish();
+
+    if (listener != nullptr)
+        listener->coefficientsDesigned(workingSet);
+}
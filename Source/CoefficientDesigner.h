@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Turns parameter changes into complete ChainCoefficients sets for the
+    audio thread, on a background thread shared by every instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "TripleBuffer.h"
+#include "DesignTables.h"
+#include "CoefficientCache.h"
+
+class CoefficientDesigner;
+
+/**
+    The thread that designs coefficients for every CoefficientDesigner in the
+    process, held through a juce::SharedResourcePointer.
+
+    Parameter changes never wake it. Hosts deliver automation on the audio
+    thread, where juce::Thread::notify() can't be called since it takes a
+    mutex, and even asking whether this is the message thread does. So while
+    any designer is registered the thread wakes itself every pollIntervalMs
+    and designs whatever is dirty, and with none registered it blocks until
+    add() wakes it.
+*/
+class CoefficientDesignerThread : private juce::Thread
+{
+public:
+    //longest an automation change waits for a design, about one control step
+    static constexpr int pollIntervalMs = 5;
+
+    CoefficientDesignerThread();
+    ~CoefficientDesignerThread() override;
+
+    //message thread; remove() waits for a design of that designer in progress to finish
+    void add(CoefficientDesigner& designer);
+    void remove(CoefficientDesigner& designer);
+
+private:
+    void run() override;
+    bool isIdle() const;
+
+    //held while designing, so a designer is never removed mid-design
+    juce::CriticalSection designerLock;
+    juce::Array<CoefficientDesigner*> designers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesignerThread)
+};
+
+/**
+    Designs coefficients off the audio thread.
+
+    Parameter listeners call markDirty(), which only sets an atomic flag,
+    and the shared CoefficientDesignerThread picks it up on its next poll.
+    It redesigns only the dirty bands and publishes the whole set through a
+    TripleBuffer, so processBlock() picks up a complete, never-torn set with
+    a single wait-free acquire() at the start of the block.
+
+    An offline render calls designDirtyBands() itself at the start of each
+    block instead, so automation lands on the block it arrived in rather
+    than whenever the thread next wakes.
+*/
+class CoefficientDesigner
+{
+public:
+    explicit CoefficientDesigner(ChainParameters& parametersToUse);
+    ~CoefficientDesigner();
+
+    //told about every published set, on the designer thread, inside prepare() or, rendering offline, on the audio thread
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void coefficientsDesigned(const ChainCoefficients& chainCoefficients) = 0;
+    };
+
+    //message thread, before prepare()
+    void setListener(Listener* newListener) { listener = newListener; }
+
+    //message thread: designs every band synchronously for the new rate, publishes it and registers with the thread
+    void prepare(double newSampleRate);
+    //message thread: leaves the thread, waiting for a design in progress
+    void release();
+
+    //any thread, lock-free
+    void markDirty(ChainPositions band);
+    void markAllDirty();
+    //any thread, lock-free: publishes the current set again even if no band has changed, so a
+    //listener that has only just started following the sets, e.g. the FIR, gets one
+    void requestRepublish();
+
+    //message thread: publishes a set designed elsewhere, e.g. stored in a preset, from these settings
+    //by this build's design, which the caller has checked; when the parameters then arrive at the
+    //same settings there is nothing left to design
+    void publishPrecomputed(const ChainCoefficients& chainCoefficients, const ChainSettings& settings);
+
+    //audio thread: returns true if a newer set was published since the last call
+    bool acquire() noexcept { return coefficients.acquire(); }
+    //audio thread: the set returned by the last successful acquire()
+    const ChainCoefficients& getCoefficients() const noexcept { return coefficients.getReadBuffer(); }
+
+    //the designer thread, or the audio thread while rendering offline: designs the dirty bands into
+    //workingSet and publishes it, returns false if nothing was dirty and no republish was requested
+    bool designDirtyBands();
+
+private:
+    void publishWorkingSet();
+
+    ChainParameters& parameters;
+    Listener* listener{ nullptr };
+
+    std::array<std::atomic<bool>, 3> bandDirty;
+    std::atomic<bool> republishRequested{ false };
+    std::atomic<double> sampleRate{ 0.0 };
+
+    //serialises designs, taken by the audio thread only while rendering offline
+    juce::CriticalSection designLock;
+    ChainCoefficients workingSet;
+    //shared with every instance at the current rate, so automation costs lookups rather than trig
+    std::shared_ptr<const DesignTables> designTables;
+    //the settings workingSet was designed from, valid only at the current rate
+    ChainSettings designedSettings;
+    bool hasDesignedSettings{ false };
+
+    TripleBuffer<ChainCoefficients> coefficients;
+
+    //band designs shared by every instance in the process, so duplicated settings are designed once
+    juce::SharedResourcePointer<CoefficientCache> cache;
+    juce::SharedResourcePointer<CoefficientDesignerThread> designerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    CurveRenderThread.cpp
+    One background thread, shared by every open editor, that renders
+    response curves into images.
+
+  ==============================================================================
+*/
+
+#include "CurveRenderThread.h"
+
+CurveRenderThread::CurveRenderThread() :
+    juce::Thread("SimpleEQ curve renderer")
+{
+    startThread();
+}
+
+CurveRenderThread::~CurveRenderThread()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
+
+void CurveRenderThread::addClient(Client& client)
+{
+    {
+        const juce::ScopedLock sl(clientLock);
+        clients.addIfNotAlreadyThere(&client);
+    }
+
+    //anything that changed while it was away
+    if (client.dirty)
+        notify();
+}
+
+void CurveRenderThread::removeClient(Client& client)
+{
+    const juce::ScopedLock sl(clientLock);
+    clients.removeFirstMatchingValue(&client);
+}
+
+void CurveRenderThread::markDirty(Client& client)
+{
+    client.dirty.store(true);
+    notify();
+}
+
+void CurveRenderThread::run()
+{
+    while (!threadShouldExit())
+    {
+        //a burst of changes coalesces into one render per client
+        wait(-1);
+
+        if (threadShouldExit())
+            break;
+
+        const juce::ScopedLock sl(clientLock);
+
+        for (auto* client : clients)
+            if (client->dirty.exchange(false))
+                client->renderCurve();
+    }
+}
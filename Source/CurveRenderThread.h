@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    CurveRenderThread.h
+    One background thread, shared by every open editor, that renders
+    response curves into images.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Renders curves for every registered Client off the message thread.
+
+    Hold it through a juce::SharedResourcePointer so all editors in the
+    process share a single thread, which only exists while at least one
+    editor does. The thread sleeps until markDirty() is called and then
+    renders every client whose dirty flag is set, so the thread never polls
+    and a client that isn't registered, e.g. a hidden editor, costs nothing.
+*/
+class CurveRenderThread : private juce::Thread
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+
+        //called on the render thread
+        virtual void renderCurve() = 0;
+
+        std::atomic<bool> dirty{ true };
+    };
+
+    CurveRenderThread();
+    ~CurveRenderThread() override;
+
+    //message thread; removeClient() waits for a render of that client in progress to finish
+    void addClient(Client& client);
+    void removeClient(Client& client);
+
+    //any thread but the audio thread, since waking the thread takes a lock: sets the client's
+    //dirty flag and wakes the thread
+    void markDirty(Client& client);
+
+private:
+    void run() override;
+
+    //held while rendering, so a client is never removed mid-render
+    juce::CriticalSection clientLock;
+    juce::Array<Client*> clients;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CurveRenderThread)
+};
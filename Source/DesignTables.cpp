@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    DesignTables.cpp
+    Per-sample-rate tables that replace the trig in the LowCut, Peak and
+    HighCut designers with lookups.
+
+  ==============================================================================
+*/
+
+#include "DesignTables.h"
+
+namespace
+{
+    //highest frequency tabulated, as a fraction of the sample rate, so the point past the top stays below Nyquist
+    constexpr double maxNormalisedFrequency = 0.47;
+
+    //one table step in the variable the derivatives are taken against
+    constexpr double octaveStep = 1.0 / DesignTables::pointsPerOctave;
+}
+
+void DesignTables::prepare(double newSampleRate)
+{
+    jassert(newSampleRate > 0.0);
+
+    sampleRate = newSampleRate;
+    tableMaxFrequency = (float)juce::jmin((double)maxFrequency, maxNormalisedFrequency * sampleRate);
+
+    //one point past the top, so every frequency in range has a neighbour above it
+    const auto numOctaves = std::log2((double)tableMaxFrequency / minFrequency);
+    const auto numPoints = juce::jmax(2, (int)std::floor(numOctaves * pointsPerOctave) + 2);
+
+    frequencyPoints.resize((size_t)numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        //f = minFrequency * 2^u, so d/du of g(c f) is g'(c f) * c f * ln 2
+        const auto frequency = minFrequency * std::pow(2.0, i * octaveStep);
+        const auto theta = juce::MathConstants<double>::pi * frequency / sampleRate;
+        const auto omega = 2.0 * theta;
+        const auto step = octaveStep * std::log(2.0);
+
+        const auto halfSine = std::sin(theta);
+        const auto halfCosine = std::cos(theta);
+        const auto sine = std::sin(omega);
+        const auto cosine = std::cos(omega);
+
+        auto& point = frequencyPoints[(size_t)i];
+        point.halfSine = { (float)halfSine, (float)(halfCosine * theta * step) };
+        point.halfCosine = { (float)halfCosine, (float)(-halfSine * theta * step) };
+        point.sine = { (float)sine, (float)(cosine * omega * step) };
+        point.cosine = { (float)cosine, (float)(-sine * omega * step) };
+    }
+
+    //A = 10^(dB / 40), dA/ddB = A ln(10) / 40
+    const auto numGainPoints = juce::roundToInt((maxGainInDecibels - minGainInDecibels) / gainStepInDecibels) + 1;
+    amplitudePoints.resize((size_t)numGainPoints);
+
+    for (int i = 0; i < numGainPoints; ++i)
+    {
+        const auto decibels = (double)minGainInDecibels + i * (double)gainStepInDecibels;
+        const auto amplitude = std::pow(10.0, decibels / 40.0);
+
+        amplitudePoints[(size_t)i] = { (float)amplitude, (float)(amplitude * std::log(10.0) / 40.0 * gainStepInDecibels) };
+    }
+}
+
+float DesignTables::interpolate(const Point& a, const Point& b, float t) noexcept
+{
+    //cubic Hermite basis
+    const auto t2 = t * t;
+    const auto t3 = t2 * t;
+
+    return (2.f * t3 - 3.f * t2 + 1.f) * a.value
+         + (t3 - 2.f * t2 + t) * a.slope
+         + (3.f * t2 - 2.f * t3) * b.value
+         + (t3 - t2) * b.slope;
+}
+
+bool DesignTables::findFrequency(float frequency, int& index, float& t) const noexcept
+{
+    if (!isPrepared() || !(frequency >= minFrequency && frequency <= tableMaxFrequency))
+        return false;
+
+    const auto position = std::log2(frequency / minFrequency) * (float)pointsPerOctave;
+
+    index = juce::jmin((int)position, (int)frequencyPoints.size() - 2);
+    t = position - (float)index;
+
+    return true;
+}
+
+bool DesignTables::findAmplitude(float gainInDecibels, float& amplitude) const noexcept
+{
+    const auto position = (gainInDecibels - minGainInDecibels) / gainStepInDecibels;
+
+    if (!isPrepared() || !(position >= 0.f && position <= (float)(amplitudePoints.size() - 1)))
+        return false;
+
+    const auto index = juce::jmin((int)position, (int)amplitudePoints.size() - 2);
+    amplitude = interpolate(amplitudePoints[(size_t)index], amplitudePoints[(size_t)index + 1], position - (float)index);
+
+    return true;
+}
+
+float DesignTables::getTangent(int index, float t) const noexcept
+{
+    const auto& a = frequencyPoints[(size_t)index];
+    const auto& b = frequencyPoints[(size_t)index + 1];
+
+    return interpolate(a.halfSine, b.halfSine, t) / interpolate(a.halfCosine, b.halfCosine, t);
+}
+
+BiquadCoefficients DesignTables::makePeakCoefficients(const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t, A;
+
+    if (!findFrequency(chainSettings.peakFreq, index, t) || !findAmplitude(chainSettings.peakGainInDecibels, A))
+        return ::makePeakCoefficients(chainSettings, sampleRate);
+
+    const auto& a = frequencyPoints[(size_t)index];
+    const auto& b = frequencyPoints[(size_t)index + 1];
+
+    //ArrayCoefficients::makePeakFilter
+    const auto alpha = interpolate(a.sine, b.sine, t) / (chainSettings.peakQuality * 2.f);
+    const auto c2 = -2.f * interpolate(a.cosine, b.cosine, t);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+
+    return { 1.f + alphaTimesA, c2, 1.f - alphaTimesA, 1.f + alphaOverA, c2, 1.f - alphaOverA };
+}
+
+void DesignTables::makeLowCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t;
+
+    if (!findFrequency(chainSettings.lowCutFreq, index, t))
+        return ::makeLowCutCoefficients(destination, chainSettings, sampleRate);
+
+    const auto n = getTangent(index, t);
+    const auto nSquared = n * n;
+
+    //ArrayCoefficients::makeHighPass, once per Butterworth section
+    for (int i = 0; i <= chainSettings.lowCutSlope; ++i)
+    {
+        const auto invQ = 1.f / butterworthQs[(size_t)chainSettings.lowCutSlope][(size_t)i];
+        const auto c1 = 1.f / (1.f + invQ * n + nSquared);
+
+        destination[(size_t)i] = { c1, c1 * -2.f, c1, 1.f, c1 * 2.f * (nSquared - 1.f), c1 * (1.f - invQ * n + nSquared) };
+    }
+}
+
+void DesignTables::makeHighCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t;
+
+    if (isHighCutParked(chainSettings, sampleRate) || !findFrequency(chainSettings.highCutFreq, index, t))
+        return ::makeHighCutCoefficients(destination, chainSettings, sampleRate);
+
+    const auto n = 1.f / getTangent(index, t);
+    const auto nSquared = n * n;
+
+    //ArrayCoefficients::makeLowPass, once per Butterworth section
+    for (int i = 0; i <= chainSettings.highCutSlope; ++i)
+    {
+        const auto invQ = 1.f / butterworthQs[(size_t)chainSettings.highCutSlope][(size_t)i];
+        const auto c1 = 1.f / (1.f + invQ * n + nSquared);
+
+        destination[(size_t)i] = { c1, c1 * 2.f, c1, 1.f, c1 * 2.f * (1.f - nSquared), c1 * (1.f - invQ * n + nSquared) };
+    }
+}
+
+SvfCoefficients DesignTables::makePeakSvfCoefficients(const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t, A;
+
+    if (!findFrequency(chainSettings.peakFreq, index, t) || !findAmplitude(chainSettings.peakGainInDecibels, A))
+        return ::makePeakSvfCoefficients(chainSettings, sampleRate);
+
+    const auto k = 1.0 / (chainSettings.peakQuality * (double)A);
+
+    return { (double)getTangent(index, t), k, 1.0, k * ((double)A * A - 1.0), 0.0 };
+}
+
+void DesignTables::makeLowCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t;
+
+    if (!findFrequency(chainSettings.lowCutFreq, index, t))
+        return ::makeLowCutSvfCoefficients(destination, chainSettings, sampleRate);
+
+    const auto g = (double)getTangent(index, t);
+
+    for (int i = 0; i <= chainSettings.lowCutSlope; ++i)
+    {
+        const auto k = 1.0 / butterworthQs[(size_t)chainSettings.lowCutSlope][(size_t)i];
+        destination[(size_t)i] = { g, k, 1.0, -k, -1.0 };
+    }
+}
+
+void DesignTables::makeHighCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings) const noexcept
+{
+    int index;
+    float t;
+
+    if (isHighCutParked(chainSettings, sampleRate) || !findFrequency(chainSettings.highCutFreq, index, t))
+        return ::makeHighCutSvfCoefficients(destination, chainSettings, sampleRate);
+
+    const auto g = (double)getTangent(index, t);
+
+    for (int i = 0; i <= chainSettings.highCutSlope; ++i)
+    {
+        const auto k = 1.0 / butterworthQs[(size_t)chainSettings.highCutSlope][(size_t)i];
+        destination[(size_t)i] = { g, k, 0.0, 0.0, 1.0 };
+    }
+}
@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    FilterDesign.cpp
+    Parameter snapshots and allocation-free coefficient design for the
+    LowCut, Peak and HighCut bands.
+
+  ==============================================================================
+*/
+
+#include "FilterDesign.h"
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+    ChainSettings settings;
+
+    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
+    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
+    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
+    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
+    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
+    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
+    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    
+    return settings;
+}
+
+static bool isClose(float a, float b)
+{
+    return std::abs(a - b) <= 1.0e-5f * juce::jmax(1.f, std::abs(a), std::abs(b));
+}
+
+bool isLowCutEqual(const ChainSettings& a, const ChainSettings& b)
+{
+    return isClose(a.lowCutFreq, b.lowCutFreq) && a.lowCutSlope == b.lowCutSlope;
+}
+
+bool isPeakEqual(const ChainSettings& a, const ChainSettings& b)
+{
+    return isClose(a.peakFreq, b.peakFreq) && isClose(a.peakGainInDecibels, b.peakGainInDecibels)
+        && isClose(a.peakQuality, b.peakQuality);
+}
+
+bool isHighCutEqual(const ChainSettings& a, const ChainSettings& b)
+{
+    return isClose(a.highCutFreq, b.highCutFreq) && a.highCutSlope == b.highCutSlope;
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts) :
+    lowCutFreq(apvts.getRawParameterValue("LowCut Freq")),
+    highCutFreq(apvts.getRawParameterValue("HighCut Freq")),
+    peakFreq(apvts.getRawParameterValue("Peak Freq")),
+    peakGainInDecibels(apvts.getRawParameterValue("Peak Gain")),
+    peakQuality(apvts.getRawParameterValue("Peak Quality")),
+    lowCutSlope(apvts.getRawParameterValue("LowCut Slope")),
+    highCutSlope(apvts.getRawParameterValue("HighCut Slope"))
+{
+    jassert(lowCutFreq != nullptr && highCutFreq != nullptr && peakFreq != nullptr && peakGainInDecibels != nullptr
+        && peakQuality != nullptr && lowCutSlope != nullptr && highCutSlope != nullptr);
+}
+
+ChainSettings ChainParameters::load() const
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = lowCutFreq->load();
+    settings.highCutFreq = highCutFreq->load();
+    settings.peakFreq = peakFreq->load();
+    settings.peakGainInDecibels = peakGainInDecibels->load();
+    settings.peakQuality = peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
+
+    return settings;
+}
+
+BiquadCoefficients makePeakCoefficients(const ChainSettings& chainSettings, double sampleRate) {
+    return juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter(
+        sampleRate,
+        chainSettings.peakFreq,
+        chainSettings.peakQuality,
+        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+//same section layout as FilterDesign's designIIR*HighOrderButterworthMethod for an even order
+template<typename SectionDesigner>
+static void makeButterworthCoefficients(CutCoefficients& destination, Slope slope, SectionDesigner&& designSection)
+{
+    const auto& sectionQs = butterworthQs[(size_t)slope];
+
+    for (int i = 0; i <= slope; ++i)
+        destination[(size_t)i] = designSection(sectionQs[(size_t)i]);
+}
+
+void makeLowCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings, double sampleRate) {
+    makeButterworthCoefficients(destination, chainSettings.lowCutSlope, [&](float Q) {
+        return juce::dsp::IIR::ArrayCoefficients<float>::makeHighPass(sampleRate, chainSettings.lowCutFreq, Q);
+        });
+}
+
+void makeHighCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings, double sampleRate) {
+    const auto parked = isHighCutParked(chainSettings, sampleRate);
+
+    makeButterworthCoefficients(destination, chainSettings.highCutSlope, [&](float Q) {
+        return parked ? passThroughCoefficients : juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, chainSettings.highCutFreq, Q);
+        });
+}
+
+//g for a prewarped frequency, clamped like the biquad designers clamp theirs
+static double getPrewarpedFrequency(float frequency, double sampleRate)
+{
+    return std::tan(juce::MathConstants<double>::pi * juce::jmax((double)frequency, 2.0) / sampleRate);
+}
+
+SvfCoefficients makePeakSvfCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    //the RBJ bell is (s^2 + k A^2 s + 1) / (s^2 + k s + 1) with k = 1 / (Q A)
+    const auto A = std::pow(10.0, chainSettings.peakGainInDecibels / 40.0);
+    const auto k = 1.0 / (chainSettings.peakQuality * A);
+
+    return { getPrewarpedFrequency(chainSettings.peakFreq, sampleRate), k, 1.0, k * (A * A - 1.0), 0.0 };
+}
+
+void makeLowCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings, double sampleRate)
+{
+    const auto g = getPrewarpedFrequency(chainSettings.lowCutFreq, sampleRate);
+
+    //high pass, s^2 / (s^2 + k s + 1)
+    for (int i = 0; i <= chainSettings.lowCutSlope; ++i)
+    {
+        const auto k = 1.0 / butterworthQs[(size_t)chainSettings.lowCutSlope][(size_t)i];
+        destination[(size_t)i] = { g, k, 1.0, -k, -1.0 };
+    }
+}
+
+void makeHighCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings, double sampleRate)
+{
+    const auto g = getPrewarpedFrequency(chainSettings.highCutFreq, sampleRate);
+
+    //low pass, 1 / (s^2 + k s + 1)
+    for (int i = 0; i <= chainSettings.highCutSlope; ++i)
+    {
+        const auto k = 1.0 / butterworthQs[(size_t)chainSettings.highCutSlope][(size_t)i];
+        destination[(size_t)i] = isHighCutParked(chainSettings, sampleRate) ? SvfCoefficients{} : SvfCoefficients{ g, k, 0.0, 0.0, 1.0 };
+    }
+}
+
+void makeChainCoefficients(ChainCoefficients& destination, const ChainSettings& chainSettings, double sampleRate)
+{
+    makeLowCutCoefficients(destination.lowCut, chainSettings, sampleRate);
+    destination.peak = makePeakCoefficients(chainSettings, sampleRate);
+    makeHighCutCoefficients(destination.highCut, chainSettings, sampleRate);
+
+    makeLowCutSvfCoefficients(destination.lowCutSvf, chainSettings, sampleRate);
+    destination.peakSvf = makePeakSvfCoefficients(chainSettings, sampleRate);
+    makeHighCutSvfCoefficients(destination.highCutSvf, chainSettings, sampleRate);
+
+    destination.lowCutSlope = chainSettings.lowCutSlope;
+    destination.highCutSlope = chainSettings.highCutSlope;
+
+    for (auto& version : destination.bandVersions)
+        ++version;
+}
+
+//same evaluation as IIR::Coefficients::getMagnitudeForFrequency, a0 cancels out in the ratio
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate)
+{
+    constexpr std::complex<double> j(0, 1);
+    const auto jw = std::exp(-juce::MathConstants<double>::twoPi * frequency * j / sampleRate);
+
+    std::complex<double> numerator = 0.0, denominator = 0.0, factor = 1.0;
+
+    for (size_t n = 0; n < 3; ++n)
+    {
+        numerator += static_cast<double>(coefficients[n]) * factor;
+        denominator += static_cast<double>(coefficients[n + 3]) * factor;
+        factor *= jw;
+    }
+
+    return std::abs(numerator / denominator);
+}
+
+double getMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate)
+{
+    auto mag = getMagnitudeForFrequency(chainCoefficients.peak, frequency, sampleRate);
+
+    for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+        mag *= getMagnitudeForFrequency(chainCoefficients.lowCut[(size_t)i], frequency, sampleRate);
+
+    for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+        mag *= getMagnitudeForFrequency(chainCoefficients.highCut[(size_t)i], frequency, sampleRate);
+
+    return mag;
+}
+
+int getDecayLengthInSamples(const BiquadCoefficients& coefficients, double threshold)
+{
+    //poles of z^2 + a1 z + a2 after normalising by a0
+    const auto a1 = static_cast<double>(coefficients[4]) / coefficients[3];
+    const auto a2 = static_cast<double>(coefficients[5]) / coefficients[3];
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    const auto radius = discriminant < 0.0 ? std::sqrt(a2)
+                                           : (std::abs(a1) + std::sqrt(discriminant)) * 0.5;
+
+    if (radius <= 0.0)
+        return 2;
+
+    //marginally stable or worse never decays, cap it
+    if (radius >= 1.0)
+        return std::numeric_limits<int>::max();
+
+    //+2 for the section's own two-sample memory
+    const auto samples = std::ceil(std::log(threshold) / std::log(radius)) + 2.0;
+    return (int)juce::jmin(samples, (double)std::numeric_limits<int>::max());
+}
+
+int getDecayLengthInSamples(const ChainCoefficients& chainCoefficients, double threshold)
+{
+    auto getSectionLength = [threshold](const BiquadCoefficients& coefficients, const SvfCoefficients& prototype)
+    {
+        return isIdentity(prototype) ? 0 : getDecayLengthInSamples(coefficients, threshold);
+    };
+
+    juce::int64 total = getSectionLength(chainCoefficients.peak, chainCoefficients.peakSvf);
+
+    for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+        total += getSectionLength(chainCoefficients.lowCut[(size_t)i], chainCoefficients.lowCutSvf[(size_t)i]);
+
+    for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+        total += getSectionLength(chainCoefficients.highCut[(size_t)i], chainCoefficients.highCutSvf[(size_t)i]);
+
+    return (int)juce::jmin(total, (juce::int64)std::numeric_limits<int>::max());
+}
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    FilterDesign.h
+    Parameter snapshots and allocation-free coefficient design for the
+    LowCut, Peak and HighCut bands.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//for slope settings
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+//struct for apvts params
+struct ChainSettings
+{
+    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+};
+
+//helper fn to get param values
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+//a HighCut at or above Nyquist has nothing left to cut, so every designer makes it pass-through sections.
+//Neither end of a range is parked otherwise: a 20 Hz high pass, and at 44.1 and 48 kHz a 20 kHz low pass,
+//still shape the band, as they always have
+inline bool isHighCutParked(const ChainSettings& chainSettings, double sampleRate) noexcept { return chainSettings.highCutFreq >= sampleRate * 0.5; }
+
+//bumped whenever the designers below make different coefficients for the same settings, so sets
+//stored by another build, e.g. in a preset, are designed again rather than trusted
+constexpr int coefficientDesignVersion = 2;
+
+//whether two snapshots design the same band, to within a parameter round trip through the host
+bool isLowCutEqual(const ChainSettings& a, const ChainSettings& b);
+bool isPeakEqual(const ChainSettings& a, const ChainSettings& b);
+bool isHighCutEqual(const ChainSettings& a, const ChainSettings& b);
+
+//raw parameter pointers looked up once, so the audio thread never does string-keyed lookups
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+
+    ChainSettings load() const;
+
+    std::atomic<float>* lowCutFreq{ nullptr };
+    std::atomic<float>* highCutFreq{ nullptr };
+    std::atomic<float>* peakFreq{ nullptr };
+    std::atomic<float>* peakGainInDecibels{ nullptr };
+    std::atomic<float>* peakQuality{ nullptr };
+    std::atomic<float>* lowCutSlope{ nullptr };
+    std::atomic<float>* highCutSlope{ nullptr };
+};
+
+//enum to represent each link's position in the chain
+enum ChainPositions {
+    LowCut,
+    Peak,
+    HighCut
+};
+
+//raw biquad coefficients {b0, b1, b2, a0, a1, a2}, as produced by IIR::ArrayCoefficients
+using BiquadCoefficients = std::array<float, 6>;
+//one biquad per 12 dB/Oct of cut slope
+using CutCoefficients = std::array<BiquadCoefficients, 4>;
+
+//per slope, the Q of each Butterworth section, 1 / (2 cos((2i + 1) pi / 2N)) for order N
+constexpr std::array<std::array<float, 4>, 4> butterworthQs
+{ {
+    { 0.7071067811865475f },
+    { 0.5411961001461970f, 1.3065629648763764f },
+    { 0.5176380902050415f, 0.7071067811865475f, 1.9318516525781368f },
+    { 0.5097955791041592f, 0.6013448869350453f, 0.8999762231364156f, 2.5629154477415055f },
+} };
+
+/**
+    One section as the analog prototype the bilinear designs share, in the
+    terms of a TPT state-variable filter: g = tan(pi f / fs), damping k, and
+    the mix m0 input + m1 band + m2 low. Kept in double and free of the
+    cancellation that a1 ~ -2 suffers in a float biquad, so the double path
+    and the state-variable topology can be built from it exactly. The default
+    is a pass-through.
+*/
+struct SvfCoefficients
+{
+    double g{ 1.0 }, k{ 1.0 }, m0{ 1.0 }, m1{ 0.0 }, m2{ 0.0 };
+};
+
+using CutSvfCoefficients = std::array<SvfCoefficients, 4>;
+
+//a section that passes its input through unchanged, in either form
+constexpr BiquadCoefficients passThroughCoefficients{ 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+
+//whether a prototype is exactly the identity, e.g. a 0 dB bell or a HighCut parked at Nyquist
+inline bool isIdentity(const SvfCoefficients& prototype) noexcept
+{
+    return prototype.m0 == 1.0 && prototype.m1 == 0.0 && prototype.m2 == 0.0;
+}
+
+//a complete, self-contained coefficient set for the whole chain
+struct ChainCoefficients
+{
+    CutCoefficients lowCut{};
+    BiquadCoefficients peak{};
+    CutCoefficients highCut{};
+    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+    //the same bands as prototypes, for everything that doesn't run float biquads
+    CutSvfCoefficients lowCutSvf{};
+    SvfCoefficients peakSvf{};
+    CutSvfCoefficients highCutSvf{};
+
+    //bumped each time a band is redesigned, indexed by ChainPositions
+    std::array<juce::uint32, 3> bandVersions{};
+};
+
+//allocation-free designers, safe to call from any thread
+BiquadCoefficients makePeakCoefficients(const ChainSettings& chainSettings, double sampleRate);
+void makeLowCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings, double sampleRate);
+void makeHighCutCoefficients(CutCoefficients& destination, const ChainSettings& chainSettings, double sampleRate);
+//the prototypes of the same designs, in double
+SvfCoefficients makePeakSvfCoefficients(const ChainSettings& chainSettings, double sampleRate);
+void makeLowCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings, double sampleRate);
+void makeHighCutSvfCoefficients(CutSvfCoefficients& destination, const ChainSettings& chainSettings, double sampleRate);
+//designs every band at once, both forms, e.g. for display
+void makeChainCoefficients(ChainCoefficients& destination, const ChainSettings& chainSettings, double sampleRate);
+
+//linear magnitude of one section, or of every active section of the chain, at a frequency
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate);
+double getMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate);
+
+//samples until a section's impulse response falls below threshold, from its pole radius;
+//the chain overload sums its active sections, which overestimates rather than under, and
+//leaves out identity sections, whose poles cancel
+int getDecayLengthInSamples(const BiquadCoefficients& coefficients, double threshold);
+int getDecayLengthInSamples(const ChainCoefficients& chainCoefficients, double threshold);
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.cpp
+    The cascade kernels built once per instruction set, and the pick of the
+    best one this CPU runs.
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if SIMPLEEQ_KERNEL_DISPATCH
+
+#ifndef SIMPLEEQ_KERNEL_AVX2
+ #define SIMPLEEQ_KERNEL_AVX2 0
+#endif
+
+#ifndef SIMPLEEQ_KERNEL_AVX512
+ #define SIMPLEEQ_KERNEL_AVX512 0
+#endif
+
+namespace CascadeKernel
+{
+    //defined by KernelVariant.cpp, once for each instruction set the build compiled it for
+    namespace baseline { extern const KernelVariant variant; }
+
+   #if SIMPLEEQ_KERNEL_AVX2
+    namespace avx2 { extern const KernelVariant variant; }
+   #endif
+
+   #if SIMPLEEQ_KERNEL_AVX512
+    namespace avx512 { extern const KernelVariant variant; }
+   #endif
+}
+
+namespace
+{
+    using CascadeKernel::InstructionSet;
+
+    InstructionSet detectInstructionSet() noexcept
+    {
+       #if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+        //the checks include whether the OS saves the wider registers
+        __builtin_cpu_init();
+
+       #if SIMPLEEQ_KERNEL_AVX512
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")
+            && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw"))
+            return InstructionSet::avx512;
+       #endif
+
+       #if SIMPLEEQ_KERNEL_AVX2
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return InstructionSet::avx2;
+       #endif
+       #endif
+
+        return InstructionSet::baseline;
+    }
+
+    //SIMPLEEQ_KERNELS, if it names an instruction set
+    bool getRequestedInstructionSet(InstructionSet& requested) noexcept
+    {
+        const auto* name = std::getenv("SIMPLEEQ_KERNELS");
+
+        if (name == nullptr)
+            return false;
+
+        for (auto instructionSet : { InstructionSet::baseline, InstructionSet::avx2, InstructionSet::avx512 })
+        {
+            const auto matches = std::strcmp(name, CascadeKernel::getName(instructionSet)) == 0
+                              || (instructionSet == InstructionSet::baseline && std::strcmp(name, "baseline") == 0);
+
+            if (matches)
+            {
+                requested = instructionSet;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+namespace CascadeKernel
+{
+
+InstructionSet getBestInstructionSet() noexcept
+{
+    static const auto best = detectInstructionSet();
+    return best;
+}
+
+const KernelVariant& getKernelVariant(InstructionSet instructionSet) noexcept
+{
+    //never above what the CPU runs
+    if (instructionSet > getBestInstructionSet())
+        instructionSet = getBestInstructionSet();
+
+   #if SIMPLEEQ_KERNEL_AVX512
+    if (instructionSet == InstructionSet::avx512)
+        return avx512::variant;
+   #endif
+
+   #if SIMPLEEQ_KERNEL_AVX2
+    if (instructionSet >= InstructionSet::avx2)
+        return avx2::variant;
+   #endif
+
+    return baseline::variant;
+}
+
+const KernelVariant& getKernelVariant() noexcept
+{
+    static const auto& variant = [] () -> const KernelVariant&
+    {
+        auto instructionSet = getBestInstructionSet();
+        auto requested = instructionSet;
+
+        if (getRequestedInstructionSet(requested))
+            instructionSet = requested;
+
+        return getKernelVariant(instructionSet);
+    }();
+
+    return variant;
+}
+
+const char* getName(InstructionSet instructionSet) noexcept
+{
+    switch (instructionSet)
+    {
+       #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+        case InstructionSet::baseline: return "sse2";
+       #else
+        case InstructionSet::baseline: return "baseline";
+       #endif
+        case InstructionSet::avx2:     return "avx2";
+        case InstructionSet::avx512:   return "avx512";
+    }
+
+    return "";
+}
+
+} // namespace CascadeKernel
+
+#endif
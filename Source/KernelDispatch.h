@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.h
+    The cascade kernels built once per instruction set, and the pick of the
+    best one this CPU runs.
+
+    Free of JUCE like CascadeKernel.h, so the kernels build as a library of
+    their own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CascadeKernel.h"
+
+#include <type_traits>
+
+#ifndef SIMPLEEQ_KERNEL_DISPATCH
+ #define SIMPLEEQ_KERNEL_DISPATCH 0
+#endif
+
+namespace CascadeKernel
+{
+
+enum class InstructionSet
+{
+    //whatever the target guarantees: SSE2 on x86-64, NEON on arm64
+    baseline,
+    //AVX2 and FMA
+    avx2,
+    //AVX-512 F, VL, DQ and BW
+    avx512
+};
+
+//the engine packs channels into 128-bit lane groups whatever the instruction set: stereo fits one
+constexpr int laneGroupBytes = 16;
+
+template<typename SampleType>
+constexpr int dispatchedLanes = laneGroupBytes / (int)sizeof(SampleType);
+
+/**
+    Wider layouts run 1, 2 or 4 adjacent groups per pass, in 128-, 256- or
+    512-bit vectors, up to what the instruction set has. The state is always
+    sized for the widest pass, a narrower one uses the front of it.
+*/
+constexpr int maxGroupsPerPass = 4;
+constexpr int numPassWidths = 3;
+
+template<typename SampleType>
+constexpr int maxPassLanes = dispatchedLanes<SampleType> * maxGroupsPerPass;
+
+constexpr int maxDispatchedOrder = 4;
+
+/**
+    Cascade<Traits, Order>::process for one band shape, compiled for one
+    instruction set and pass width, indexed by Order - 1.
+*/
+template<typename SampleType, int MaxOrder>
+struct BandKernels
+{
+    template<typename SectionType>
+    using Function = void (*)(const CascadeCoefficients<SectionType, MaxOrder>&,
+                              CascadeState<SampleType, MaxOrder, maxPassLanes<SampleType>>&,
+                              SampleType*, int) noexcept;
+
+    template<typename SectionType>
+    using ByOrder = std::array<Function<SectionType>, MaxOrder>;
+
+    ByOrder<Section<SampleType>> directForm{};
+    ByOrder<SvfSection<SampleType>> stateVariable{};
+    ByOrder<SvfSweep<SampleType>> sweep{};
+
+    template<typename SectionType>
+    const ByOrder<SectionType>& get() const noexcept
+    {
+        if constexpr (std::is_same_v<SectionType, Section<SampleType>>)
+            return directForm;
+        else if constexpr (std::is_same_v<SectionType, SvfSection<SampleType>>)
+            return stateVariable;
+        else
+            return sweep;
+    }
+};
+
+//every kernel the engine runs in one precision: the cut bands and the single peak section
+template<typename SampleType>
+struct Kernels
+{
+    BandKernels<SampleType, maxDispatchedOrder> cut;
+    BandKernels<SampleType, 1> peak;
+
+    template<int MaxOrder>
+    const BandKernels<SampleType, MaxOrder>& getBand() const noexcept
+    {
+        static_assert(MaxOrder == maxDispatchedOrder || MaxOrder == 1, "No kernels for this band shape");
+
+        if constexpr (MaxOrder == 1)
+            return peak;
+        else
+            return cut;
+    }
+};
+
+struct KernelVariant
+{
+    InstructionSet instructionSet;
+    //the widest pass this instruction set has vectors for, the kernels above it are left empty
+    int maxGroupsPerPass;
+    //by pass width: 1, 2 and 4 groups
+    std::array<Kernels<float>, numPassWidths> floatKernels;
+    std::array<Kernels<double>, numPassWidths> doubleKernels;
+
+    //groupsPerPass is 1, 2 or 4, and no more than maxGroupsPerPass
+    template<typename SampleType>
+    const Kernels<SampleType>& get(int groupsPerPass) const noexcept
+    {
+        const auto index = (size_t)(groupsPerPass == 4 ? 2 : groupsPerPass - 1);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatKernels[index];
+        else
+            return doubleKernels[index];
+    }
+};
+
+//the most capable instruction set both this CPU and this build support
+InstructionSet getBestInstructionSet() noexcept;
+
+//the variant built for the given instruction set, or the best built one below it
+const KernelVariant& getKernelVariant(InstructionSet instructionSet) noexcept;
+
+/**
+    The variant everything runs, picked on first use: the best instruction set,
+    unless the SIMPLEEQ_KERNELS environment variable asks for a lower one
+    ("baseline", "avx2" or "avx512"), which is for comparing them.
+*/
+const KernelVariant& getKernelVariant() noexcept;
+
+const char* getName(InstructionSet instructionSet) noexcept;
+
+} // namespace CascadeKernel
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    KernelVariant.cpp
+    The cascade kernels for one instruction set. The build compiles this file
+    once per instruction set, with SIMPLEEQ_KERNEL_VARIANT naming it and the
+    matching code generation flags.
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+#if SIMPLEEQ_KERNEL_DISPATCH && defined(SIMPLEEQ_KERNEL_VARIANT)
+
+#include <cstring>
+
+namespace
+{
+   #if defined(__AVX512F__)
+    constexpr int variantMaxGroupsPerPass = 4;
+   #elif defined(__AVX2__)
+    constexpr int variantMaxGroupsPerPass = 2;
+   #else
+    constexpr int variantMaxGroupsPerPass = 1;
+   #endif
+
+    //a compiler vector over GroupsPerPass lane groups, compiled to whatever the flags allow
+    template<typename SampleType, int GroupsPerPass>
+    struct Vector;
+
+    template<int GroupsPerPass>
+    struct Vector<float, GroupsPerPass> { typedef float Type __attribute__((vector_size(CascadeKernel::laneGroupBytes * GroupsPerPass))); };
+
+    template<int GroupsPerPass>
+    struct Vector<double, GroupsPerPass> { typedef double Type __attribute__((vector_size(CascadeKernel::laneGroupBytes * GroupsPerPass))); };
+
+    template<typename SampleType, int GroupsPerPass>
+    struct VectorTraits
+    {
+        using Sample = SampleType;
+        using Vec = typename Vector<SampleType, GroupsPerPass>::Type;
+        static constexpr int numLanes = CascadeKernel::dispatchedLanes<SampleType> * GroupsPerPass;
+        static_assert(sizeof(Vec) == sizeof(SampleType) * numLanes, "Vector doesn't cover the lane groups");
+
+        static Vec load(const SampleType* p) noexcept { Vec v; std::memcpy(&v, p, sizeof(v)); return v; }
+        static void store(SampleType* p, Vec v) noexcept { std::memcpy(p, &v, sizeof(v)); }
+        static Vec expand(SampleType x) noexcept { return Vec{} + x; }
+    };
+
+    /**
+        Every variant instantiates the same templates with its own flags, and an
+        out-of-line copy of one of them could be shared by the linker with a
+        variant this CPU can't run. Each entry point has internal linkage and
+        inlines the whole kernel into itself, so nothing built here is shared.
+    */
+    template<int GroupsPerPass, typename SectionType, int MaxOrder, int Order>
+    __attribute__((flatten))
+    void run(const CascadeKernel::CascadeCoefficients<SectionType, MaxOrder>& coefficients,
+             CascadeKernel::CascadeState<typename SectionType::Sample, MaxOrder, CascadeKernel::maxPassLanes<typename SectionType::Sample>>& state,
+             typename SectionType::Sample* frames, int numFrames) noexcept
+    {
+        CascadeKernel::Cascade<VectorTraits<typename SectionType::Sample, GroupsPerPass>, Order>::process(coefficients, state, frames, numFrames);
+    }
+
+    template<int GroupsPerPass, typename SectionType, int MaxOrder, int... Index>
+    constexpr auto makeByOrder(std::integer_sequence<int, Index...>) noexcept
+    {
+        using Band = CascadeKernel::BandKernels<typename SectionType::Sample, MaxOrder>;
+        return typename Band::template ByOrder<SectionType>{ { &run<GroupsPerPass, SectionType, MaxOrder, Index + 1>... } };
+    }
+
+    template<int GroupsPerPass, typename SampleType, int MaxOrder>
+    constexpr CascadeKernel::BandKernels<SampleType, MaxOrder> makeBandKernels() noexcept
+    {
+        constexpr auto orders = std::make_integer_sequence<int, MaxOrder>();
+
+        CascadeKernel::BandKernels<SampleType, MaxOrder> band;
+        band.directForm = makeByOrder<GroupsPerPass, CascadeKernel::Section<SampleType>, MaxOrder>(orders);
+        band.stateVariable = makeByOrder<GroupsPerPass, CascadeKernel::SvfSection<SampleType>, MaxOrder>(orders);
+        band.sweep = makeByOrder<GroupsPerPass, CascadeKernel::SvfSweep<SampleType>, MaxOrder>(orders);
+        return band;
+    }
+
+    //empty above the widest vectors the flags give, a wider pass would only be split back up
+    template<typename SampleType, int GroupsPerPass>
+    constexpr CascadeKernel::Kernels<SampleType> makeKernels() noexcept
+    {
+        if constexpr (GroupsPerPass > variantMaxGroupsPerPass)
+            return {};
+        else
+            return { makeBandKernels<GroupsPerPass, SampleType, CascadeKernel::maxDispatchedOrder>(),
+                     makeBandKernels<GroupsPerPass, SampleType, 1>() };
+    }
+
+    template<typename SampleType>
+    constexpr std::array<CascadeKernel::Kernels<SampleType>, CascadeKernel::numPassWidths> makePassWidths() noexcept
+    {
+        static_assert(CascadeKernel::numPassWidths == 3 && CascadeKernel::maxGroupsPerPass == 4, "Pass widths changed");
+        return { makeKernels<SampleType, 1>(), makeKernels<SampleType, 2>(), makeKernels<SampleType, 4>() };
+    }
+}
+
+namespace CascadeKernel
+{
+namespace SIMPLEEQ_KERNEL_VARIANT
+{
+    //constant initialised, ready before any static constructor could ask for it
+    extern const KernelVariant variant;
+    const KernelVariant variant{ InstructionSet::SIMPLEEQ_KERNEL_VARIANT, variantMaxGroupsPerPass,
+                                 makePassWidths<float>(), makePassWidths<double>() };
+}
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+    Linear-phase FIR version of the chain, applied by partitioned FFT
+    convolution.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+
+void LinearPhaseEngine::prepare(int numChannels, double newSampleRate, int maximumBlockSize,
+                                PartitionedConvolver::Layout layout)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+
+    if (designFft == nullptr)
+    {
+        designFft = std::make_unique<juce::dsp::FFT>(firOrder);
+        spectrum.resize((size_t)firLength);
+        impulse.resize((size_t)firLength);
+        window.resize((size_t)firLength);
+        taps.resize((size_t)firLength);
+
+        //Blackman keeps the truncation ripple well below the display range
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)firLength,
+                                                                 juce::dsp::WindowingFunction<float>::blackman, false);
+    }
+
+    const auto headSize = juce::jlimit(minPartitionSize, PartitionedConvolver::maxPartitionSize,
+                                       juce::nextPowerOfTwo(maximumBlockSize));
+
+    convolver.prepare(numChannels, headSize, firLength, sampleRate, layout);
+}
+
+void LinearPhaseEngine::design(const ChainCoefficients& chainCoefficients)
+{
+    const juce::ScopedLock sl(designLock);
+
+    if (sampleRate <= 0.0 || designFft == nullptr)
+        return;
+
+    //zero-phase spectrum: the chain's magnitude at every bin, mirrored
+    for (int bin = 0; bin <= firLength / 2; ++bin)
+    {
+        const auto frequency = bin * sampleRate / firLength;
+        const auto magnitude = (float)getMagnitudeForFrequency(chainCoefficients, frequency, sampleRate);
+
+        spectrum[(size_t)bin] = { magnitude, 0.f };
+
+        if (bin > 0 && bin < firLength / 2)
+            spectrum[(size_t)(firLength - bin)] = { magnitude, 0.f };
+    }
+
+    //the inverse transform scales by 1 / firLength
+    designFft->perform(spectrum.data(), impulse.data(), true);
+
+    //rotate the zero-phase response so its centre lands at firLength / 2, then window
+    for (int n = 0; n < firLength; ++n)
+        taps[(size_t)n] = impulse[(size_t)((n + firLength / 2) % firLength)].real() * window[(size_t)n];
+
+    convolver.setImpulseResponse(taps.data(), firLength);
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+    Linear-phase FIR version of the chain, applied by partitioned FFT
+    convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "PartitionedConvolver.h"
+
+/**
+    Applies the chain's magnitude response with zero phase distortion.
+
+    design() samples the magnitude of a ChainCoefficients set on a linear
+    frequency grid, takes it through an inverse FFT as a zero-phase response,
+    centres it and windows it into a symmetric FIR of firLength taps, which
+    the PartitionedConvolver crossfades to without the audio thread waiting.
+
+    The head partition follows the host block size, so at small buffers most
+    of the FIR is convolved in large partitions on the worker threads and the
+    callback only pays for the first few hundred taps.
+
+    Latency is firLength / 2 for the FIR's centre plus one head partition.
+*/
+class LinearPhaseEngine
+{
+public:
+    static constexpr int firOrder = 12;
+    static constexpr int firLength = 1 << firOrder;
+
+    static constexpr int minPartitionSize = 64;
+
+    //message thread, the head partition follows the host block size
+    void prepare(int numChannels, double sampleRate, int maximumBlockSize,
+                 PartitionedConvolver::Layout layout = PartitionedConvolver::Layout::nonUniform);
+    //message thread: the convolution workers only look at the FIR while it's in use
+    void setActive(bool shouldBeActive) { convolver.setActive(shouldBeActive); }
+    //audio thread too, never waits: forgets the input so far, keeps the FIR
+    void reset() noexcept { convolver.reset(); }
+
+    //any thread but a real-time audio thread: designs the FIR for these coefficients, fades in on the next partition
+    void design(const ChainCoefficients& chainCoefficients);
+
+    //any thread: offline, process() waits for the convolution workers rather than dropping late blocks
+    void setNonRealtime(bool isNonRealtime) noexcept { convolver.setNonRealtime(isNonRealtime); }
+
+    //audio thread
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept { convolver.process(block); }
+
+    int getLatencySamples() const noexcept { return firLength / 2 + convolver.getLatencySamples(); }
+    //samples until the output has gone quiet after the input has
+    int getTailSamples() const noexcept { return firLength + convolver.getLatencySamples(); }
+
+    const PartitionedConvolver& getConvolver() const noexcept { return convolver; }
+
+private:
+    //serialises prepare() against design(), never taken by the audio thread
+    juce::CriticalSection designLock;
+
+    double sampleRate{ 0.0 };
+
+    std::unique_ptr<juce::dsp::FFT> designFft;
+    std::vector<std::complex<float>> spectrum, impulse;
+    std::vector<float> window, taps;
+
+    PartitionedConvolver convolver;
+};
@@ -0,0 +1,548 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Non-uniformly partitioned FFT convolution, with the tail partitions
+    computed on shared worker threads.
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+struct ConvolutionWorkers::Worker : juce::Thread
+{
+    Worker(ConvolutionWorkers& ownerToUse, int index) :
+        juce::Thread("SimpleEQ convolution worker " + juce::String(index)),
+        owner(ownerToUse)
+    {
+    }
+
+    void run() override
+    {
+        //with no convolver registered there is nothing to poll for, add() wakes the thread
+        while (!threadShouldExit())
+            if (!owner.runNext())
+                wait(owner.isIdle() ? -1 : 1);
+    }
+
+    ConvolutionWorkers& owner;
+};
+
+ConvolutionWorkers::ConvolutionWorkers()
+{
+    //leave a core for the audio thread
+    const auto numThreads = juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numThreads; ++i)
+        threads.add(new Worker(*this, i))->startThread();
+}
+
+ConvolutionWorkers::~ConvolutionWorkers()
+{
+    for (auto* thread : threads)
+        thread->signalThreadShouldExit();
+
+    for (auto* thread : threads)
+    {
+        thread->notify();
+        thread->stopThread(1000);
+    }
+}
+
+void ConvolutionWorkers::add(PartitionedConvolver& convolver)
+{
+    {
+        const juce::ScopedWriteLock sl(lock);
+        convolvers.addIfNotAlreadyThere(&convolver);
+    }
+
+    for (auto* thread : threads)
+        thread->notify();
+}
+
+void ConvolutionWorkers::remove(PartitionedConvolver& convolver)
+{
+    const juce::ScopedWriteLock sl(lock);
+    convolvers.removeFirstMatchingValue(&convolver);
+}
+
+bool ConvolutionWorkers::isIdle() const
+{
+    const juce::ScopedReadLock sl(lock);
+    return convolvers.isEmpty();
+}
+
+bool ConvolutionWorkers::runNext()
+{
+    const juce::ScopedReadLock sl(lock);
+
+    PartitionedConvolver* earliest = nullptr;
+    int earliestSegment = 0;
+    juce::int64 earliestDeadline = 0;
+
+    for (auto* convolver : convolvers)
+    {
+        juce::int64 deadline;
+        int segment;
+
+        if (convolver->getEarliestDeadline(deadline, segment) && (earliest == nullptr || deadline < earliestDeadline))
+        {
+            earliest = convolver;
+            earliestSegment = segment;
+            earliestDeadline = deadline;
+        }
+    }
+
+    //another worker may have claimed it in the meantime, then just look again
+    return earliest != nullptr && earliest->runPendingBlock(earliestSegment);
+}
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver() = default;
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    workers->remove(*this);
+}
+
+void PartitionedConvolver::prepare(int newNumChannels, int newHeadSize, int maxLength, double sampleRate, Layout layout)
+{
+    jassert(juce::isPowerOfTwo(newHeadSize) && newHeadSize <= maxPartitionSize);
+
+    //no worker may be inside a segment while they're rebuilt
+    workers->remove(*this);
+
+    numChannels = newNumChannels;
+    headSize = newHeadSize;
+    segments.clear();
+
+    //each segment ends where the next one, four times larger, can start at twice its own size
+    for (int offset = 0, size = headSize; offset < maxLength; size *= 4)
+    {
+        const auto nextSize = size * 4;
+        const auto hasNext = layout == Layout::nonUniform && nextSize <= maxPartitionSize && nextSize * 2 < maxLength;
+        const auto end = hasNext ? nextSize * 2 : maxLength;
+
+        auto segment = std::make_unique<Segment>();
+        segment->size = size;
+        segment->offset = offset;
+        segment->numPartitions = (end - offset + size - 1) / size;
+        //the output of block k is first needed offset - size samples after the block is complete
+        segment->budgetSeconds = (offset - size) / sampleRate;
+
+        segments.push_back(std::move(segment));
+        offset = end;
+    }
+
+    for (auto& segment : segments)
+    {
+        const auto size = segment->size;
+        const auto numBins = (size_t)(size + 1);
+        const auto fftOrder = juce::roundToInt(std::log2(size * 2));
+
+        segment->fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+        segment->designFft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+        segment->delayLines.assign((size_t)numChannels, std::vector<Complex>((size_t)segment->numPartitions * numBins));
+        segment->outputs.assign((size_t)numChannels, std::vector<float>((size_t)(numOutputSlots * size)));
+
+        //real-only transforms work in place on twice the transform size
+        segment->fftBuffer.assign((size_t)size * 4, 0.f);
+        segment->designScratch.assign((size_t)size * 4, 0.f);
+        segment->fadeBuffer.assign((size_t)size, 0.f);
+        segment->accumulator.assign(numBins, {});
+
+        segment->kernels.forEachBuffer([&](std::vector<Complex>& kernel)
+        {
+            kernel.assign((size_t)segment->numPartitions * numBins, {});
+        });
+
+        segment->hasKernel = false;
+    }
+
+    //the largest segment reads two partitions of input, a block of it is played up to four partitions after
+    //it's posted, and this leaves room for it to be computed late by as much again before it expires
+    const auto historyLength = segments.back()->size * 8;
+    historyMask = historyLength - 1;
+    history.assign((size_t)numChannels, std::vector<float>((size_t)historyLength));
+    output.assign((size_t)numChannels, std::vector<float>((size_t)headSize));
+
+    fill = 0;
+    position = 0;
+    resetPosition.store(0, std::memory_order_relaxed);
+
+    setActive(active);
+}
+
+void PartitionedConvolver::setActive(bool shouldBeActive)
+{
+    active = shouldBeActive;
+
+    if (active && segments.size() > 1)
+        workers->add(*this);
+    else
+        workers->remove(*this);
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    //a worker may be part way through a block, so the segments and the history are left alone:
+    //computeBlock() clears a segment's delay lines when it sees the new position, and blocks
+    //with no input after it are never played
+    resetPosition.store(position, std::memory_order_release);
+
+    for (auto& channel : output)
+        std::fill(channel.begin(), channel.end(), 0.f);
+
+    //the partial head block is refilled from position
+    fill = 0;
+}
+
+void PartitionedConvolver::setImpulseResponse(const float* impulse, int length)
+{
+    for (auto& segment : segments)
+    {
+        const auto size = segment->size;
+        const auto numBins = size + 1;
+        auto& kernel = segment->kernels.getWriteBuffer();
+
+        for (int partition = 0; partition < segment->numPartitions; ++partition)
+        {
+            auto& scratch = segment->designScratch;
+            std::fill(scratch.begin(), scratch.end(), 0.f);
+
+            const auto start = segment->offset + partition * size;
+            const auto count = juce::jlimit(0, size, length - start);
+
+            if (count > 0)
+                std::copy(impulse + start, impulse + start + count, scratch.begin());
+
+            segment->designFft->performRealOnlyForwardTransform(scratch.data(), true);
+
+            const auto* bins = reinterpret_cast<const Complex*>(scratch.data());
+            std::copy(bins, bins + numBins, kernel.begin() + partition * numBins);
+        }
+
+        segment->kernels.publish();
+    }
+}
+
+void PartitionedConvolver::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    if (segments.empty())
+        return;
+
+    const auto channelsToProcess = juce::jmin((int)block.getNumChannels(), numChannels);
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (int done = 0; done < numSamples;)
+    {
+        const auto n = juce::jmin(numSamples - done, headSize - fill);
+        const auto writePosition = (int)((position + fill) & historyMask);
+
+        //gather input, hand out the output computed from the previous head partition
+        for (int c = 0; c < channelsToProcess; ++c)
+        {
+            auto* samples = block.getChannelPointer((size_t)c) + done;
+            auto& channelOutput = output[(size_t)c];
+
+            std::copy(samples, samples + n, history[(size_t)c].begin() + writePosition);
+            std::copy(channelOutput.begin() + fill, channelOutput.begin() + fill + n, samples);
+        }
+
+        fill += n;
+        done += n;
+
+        if (fill == headSize)
+        {
+            position += headSize;
+            fill = 0;
+            processHeadBlock();
+        }
+    }
+}
+
+void PartitionedConvolver::processHeadBlock() noexcept
+{
+    auto& head = *segments.front();
+    const auto headIndex = (int)(position / headSize) - 1;
+
+    computeBlock(head, headIndex);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const auto* source = head.outputs[(size_t)c].data() + (headIndex % numOutputSlots) * headSize;
+        std::copy(source, source + headSize, output[(size_t)c].begin());
+    }
+
+    if (segments.size() == 1)
+        return;
+
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    const auto resetAt = resetPosition.load(std::memory_order_relaxed);
+
+    for (size_t s = 1; s < segments.size(); ++s)
+    {
+        auto& segment = *segments[s];
+        const auto size = segment.size;
+
+        //a whole block of this segment's input is in, hand it to the workers
+        if (position % size == 0)
+        {
+            const auto index = (int)(position / size) - 1;
+
+            segment.deadlines[(size_t)(index % numOutputSlots)].store(now + (juce::int64)(segment.budgetSeconds * ticksPerSecond),
+                                                                      std::memory_order_relaxed);
+            segment.numPosted.store(index + 1, std::memory_order_release);
+        }
+
+        //the part of this segment's output that lines up with the head block just computed
+        const auto start = position - headSize - segment.offset;
+
+        if (start < 0)
+            continue;
+
+        const auto index = (int)(start / size);
+        const auto offsetInBlock = (int)(start % size);
+
+        segment.numExpired.store(index, std::memory_order_relaxed);
+
+        //all of its input came before the last reset(), so there is nothing to add
+        if ((juce::int64)(index + 1) * size <= resetAt)
+            continue;
+
+        if (segment.numCompleted.load(std::memory_order_acquire) <= index)
+        {
+            if (segment.lastLateIndex != index)
+            {
+                segment.lastLateIndex = index;
+                numLateBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            //deadline missed: finish it here if no worker is on the segment. In real time never wait for one
+            //that is, this part of the output is silent instead and the next head block looks again; offline
+            //there is no deadline to keep, so wait for the worker to let go
+            if (nonRealtime.load(std::memory_order_relaxed))
+            {
+                while (!tryClaim(segment))
+                    juce::Thread::yield();
+            }
+            else if (!tryClaim(segment))
+            {
+                if (segment.lastDroppedIndex != index)
+                {
+                    segment.lastDroppedIndex = index;
+                    numDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                continue;
+            }
+
+            for (auto next = segment.numCompleted.load(std::memory_order_relaxed); next <= index; ++next)
+                completeBlock(segment, next);
+
+            release(segment);
+        }
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto* source = segment.outputs[(size_t)c].data() + (index % numOutputSlots) * size + offsetInBlock;
+            juce::FloatVectorOperations::add(output[(size_t)c].data(), source, headSize);
+        }
+    }
+}
+
+bool PartitionedConvolver::tryClaim(Segment& segment) noexcept
+{
+    auto expected = false;
+    return segment.busy.compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void PartitionedConvolver::release(Segment& segment) noexcept
+{
+    segment.busy.store(false, std::memory_order_release);
+}
+
+bool PartitionedConvolver::getEarliestDeadline(juce::int64& deadline, int& segmentIndex) const noexcept
+{
+    auto found = false;
+
+    for (size_t s = 1; s < segments.size(); ++s)
+    {
+        auto& segment = *segments[s];
+        const auto next = segment.numCompleted.load(std::memory_order_acquire);
+
+        if (next >= segment.numPosted.load(std::memory_order_acquire) || segment.busy.load(std::memory_order_relaxed))
+            continue;
+
+        const auto segmentDeadline = segment.deadlines[(size_t)(next % numOutputSlots)].load(std::memory_order_relaxed);
+
+        if (!found || segmentDeadline < deadline)
+        {
+            deadline = segmentDeadline;
+            segmentIndex = (int)s;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool PartitionedConvolver::runPendingBlock(int segmentIndex) noexcept
+{
+    auto& segment = *segments[(size_t)segmentIndex];
+
+    if (!tryClaim(segment))
+        return false;
+
+    const auto next = segment.numCompleted.load(std::memory_order_relaxed);
+    const auto pending = next < segment.numPosted.load(std::memory_order_acquire);
+
+    if (pending)
+        completeBlock(segment, next);
+
+    release(segment);
+    return pending;
+}
+
+void PartitionedConvolver::completeBlock(Segment& segment, int index) noexcept
+{
+    //its output has been played already, and its input may have been overwritten since
+    if (index < segment.numExpired.load(std::memory_order_relaxed))
+        skipBlock(segment);
+    else
+        computeBlock(segment, index);
+
+    segment.numCompleted.store(index + 1, std::memory_order_release);
+}
+
+void PartitionedConvolver::skipBlock(Segment& segment) noexcept
+{
+    const auto numBins = (size_t)segment.size + 1;
+
+    segment.delayLineIndex = (segment.delayLineIndex + 1) % segment.numPartitions;
+
+    for (auto& delayLine : segment.delayLines)
+    {
+        const auto first = delayLine.begin() + (std::ptrdiff_t)((size_t)segment.delayLineIndex * numBins);
+        std::fill(first, first + (std::ptrdiff_t)numBins, Complex{});
+    }
+}
+
+void PartitionedConvolver::computeBlock(Segment& segment, int index) noexcept
+{
+    const auto size = segment.size;
+    const auto numBins = size + 1;
+    const auto slot = (index % numOutputSlots) * size;
+    const auto resetAt = resetPosition.load(std::memory_order_acquire);
+
+    //the spectra in the delay lines are all of input from before the reset
+    if (segment.appliedReset != resetAt)
+    {
+        for (auto& delayLine : segment.delayLines)
+            std::fill(delayLine.begin(), delayLine.end(), Complex{});
+
+        segment.appliedReset = resetAt;
+    }
+
+    segment.delayLineIndex = (segment.delayLineIndex + 1) % segment.numPartitions;
+
+    //overlap-save: the previous and the current block, from the history ring
+    const auto start = (juce::int64)(index - 1) * size;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& fftBuffer = segment.fftBuffer;
+        const auto& channelHistory = history[(size_t)c];
+
+        for (int half = 0; half < 2; ++half)
+        {
+            const auto first = start + half * size;
+            const auto source = (int)(first & historyMask);
+            auto destination = fftBuffer.begin() + half * size;
+
+            std::copy(channelHistory.begin() + source, channelHistory.begin() + source + size, destination);
+
+            //input from before the last reset() reads as silence
+            const auto numStale = (int)juce::jlimit((juce::int64)0, (juce::int64)size, resetAt - first);
+            std::fill(destination, destination + numStale, 0.f);
+        }
+
+        std::fill(fftBuffer.begin() + size * 2, fftBuffer.end(), 0.f);
+        segment.fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        const auto* bins = reinterpret_cast<const Complex*>(fftBuffer.data());
+        std::copy(bins, bins + numBins, segment.delayLines[(size_t)c].begin() + segment.delayLineIndex * numBins);
+
+        //the old kernel has to be used before acquire(), after that it may be overwritten
+        if (segment.hasKernel)
+            convolve(segment, c, segment.kernels.getReadBuffer(), segment.outputs[(size_t)c].data() + slot);
+    }
+
+    if (segment.kernels.acquire())
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            auto* destination = segment.outputs[(size_t)c].data() + slot;
+
+            if (!segment.hasKernel)
+            {
+                convolve(segment, c, segment.kernels.getReadBuffer(), destination);
+                continue;
+            }
+
+            //crossfade over this block from the old kernel's output to the new one's
+            convolve(segment, c, segment.kernels.getReadBuffer(), segment.fadeBuffer.data());
+
+            for (int i = 0; i < size; ++i)
+            {
+                const auto alpha = (float)(i + 1) / (float)size;
+                destination[i] += (segment.fadeBuffer[(size_t)i] - destination[i]) * alpha;
+            }
+        }
+
+        segment.hasKernel = true;
+    }
+    else if (!segment.hasKernel)
+    {
+        for (auto& slots : segment.outputs)
+            std::fill(slots.begin() + slot, slots.begin() + slot + size, 0.f);
+    }
+}
+
+void PartitionedConvolver::convolve(Segment& segment, int channel, const std::vector<Complex>& kernel, float* destination) noexcept
+{
+    const auto size = segment.size;
+    const auto numBins = size + 1;
+    const auto& delayLine = segment.delayLines[(size_t)channel];
+    auto& accumulator = segment.accumulator;
+
+    std::fill(accumulator.begin(), accumulator.end(), Complex{});
+
+    //newest input spectrum times the first partition, and so on back in time
+    for (int partition = 0; partition < segment.numPartitions; ++partition)
+    {
+        const auto slot = (segment.delayLineIndex - partition + segment.numPartitions) % segment.numPartitions;
+        const auto* x = delayLine.data() + slot * numBins;
+        const auto* h = kernel.data() + partition * numBins;
+
+        for (int bin = 0; bin < numBins; ++bin)
+            accumulator[(size_t)bin] += x[bin] * h[bin];
+    }
+
+    //the inverse real transform wants the negative frequencies filled in
+    auto& fftBuffer = segment.fftBuffer;
+    auto* bins = reinterpret_cast<Complex*>(fftBuffer.data());
+    std::copy(accumulator.begin(), accumulator.end(), bins);
+
+    for (int bin = numBins; bin < size * 2; ++bin)
+        bins[bin] = std::conj(bins[size * 2 - bin]);
+
+    segment.fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    //the second half is the part without circular wrap-around
+    std::copy(fftBuffer.begin() + size, fftBuffer.begin() + size * 2, destination);
+}
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Non-uniformly partitioned FFT convolution, with the tail partitions
+    computed on shared worker threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "TripleBuffer.h"
+
+class PartitionedConvolver;
+
+/**
+    The threads that compute tail segments for every PartitionedConvolver in
+    the process, held through a juce::SharedResourcePointer.
+
+    The audio thread never signals them, since waking a thread isn't
+    real-time safe. Instead they poll: a worker that finds nothing to do
+    sleeps for a millisecond, well inside the smallest tail budget, and only
+    blocks outright while no convolver is registered.
+*/
+class ConvolutionWorkers
+{
+public:
+    ConvolutionWorkers();
+    ~ConvolutionWorkers();
+
+    //message thread; remove() waits for a block of that convolver in progress to finish
+    void add(PartitionedConvolver& convolver);
+    void remove(PartitionedConvolver& convolver);
+
+private:
+    struct Worker;
+
+    //runs the block with the earliest deadline, returns false if nothing was pending
+    bool runNext();
+    bool isIdle() const;
+
+    //read-locked by workers while they compute, so a convolver can't go away under them
+    juce::ReadWriteLock lock;
+    juce::Array<PartitionedConvolver*> convolvers;
+    juce::OwnedArray<Worker> threads;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionWorkers)
+};
+
+/**
+    Convolves every channel with the same impulse response.
+
+    The impulse response is cut into segments. The head segment uses
+    partitions of headSize, so latency is one head partition, and is
+    computed in the audio callback. Each later segment uses partitions four
+    times larger and starts at twice its own partition size, which leaves a
+    whole partition period between an input block becoming complete and its
+    output being needed. Those segments are computed by ConvolutionWorkers.
+
+    Every posted tail block carries a deadline. Workers always take the
+    earliest one across all convolvers in the process. In real time the
+    audio thread never waits for them: when it reaches a block that still
+    isn't done it computes the block itself if no worker is on that segment,
+    and otherwise leaves that part of the output silent until the block is
+    ready, which counts as a dropped block. Either way the block counts as
+    late. A block whose output has already been played by the time anyone
+    gets to it is skipped, so a stalled worker can't fall further and
+    further behind.
+
+    Offline renders run faster than real time and reach late blocks all the
+    time, so with setNonRealtime(true) the audio thread waits for the worker
+    instead and the output never depends on how the threads were scheduled.
+
+    Only an active convolver is registered with the workers, so an idle one,
+    e.g. while linear phase is off, costs them nothing. Should it be
+    processed anyway, the audio thread computes each tail block as it comes
+    due.
+
+    reset() doesn't touch the segments either, it only marks a position in
+    the input. Whoever computes a segment's next block clears its delay line
+    then, and reads everything before that position as silence.
+
+    With Layout::uniform there is only the head segment, which is the plain
+    uniformly partitioned scheme at the same latency, kept for comparison.
+*/
+class PartitionedConvolver
+{
+public:
+    enum class Layout
+    {
+        uniform,
+        nonUniform
+    };
+
+    static constexpr int maxPartitionSize = 1024;
+
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    //message thread, headSize must be a power of two
+    void prepare(int numChannels, int headSize, int maxLength, double sampleRate, Layout layout);
+    //message thread: registers with the workers while active, leaving waits for a block of this convolver in progress
+    void setActive(bool shouldBeActive);
+    //audio thread or message thread, never waits: the output carries nothing of the input so far, keeps the impulse response
+    void reset() noexcept;
+
+    //one thread at a time, never a real-time audio thread: crossfades to this impulse response, length <= maxLength
+    void setImpulseResponse(const float* impulse, int length);
+
+    //any thread: whether process() may wait for a worker rather than drop its block
+    void setNonRealtime(bool isNonRealtime) noexcept { nonRealtime.store(isNonRealtime, std::memory_order_relaxed); }
+
+    //audio thread
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    int getLatencySamples() const noexcept { return headSize; }
+    int getNumSegments() const noexcept { return (int)segments.size(); }
+    //tail blocks that weren't ready when their output was due
+    int getNumLateBlocks() const noexcept { return numLateBlocks.load(std::memory_order_relaxed); }
+    //late blocks a worker was still on in real time, whose part of the output was left silent
+    int getNumDroppedBlocks() const noexcept { return numDroppedBlocks.load(std::memory_order_relaxed); }
+
+private:
+    friend class ConvolutionWorkers;
+
+    using Complex = std::complex<float>;
+
+    //output blocks kept per segment; at most two are ever pending
+    static constexpr int numOutputSlots = 4;
+
+    struct Segment
+    {
+        int size{ 0 }, offset{ 0 }, numPartitions{ 0 };
+        //seconds from an input block being posted until its output is needed
+        double budgetSeconds{ 0.0 };
+
+        //whoever holds busy: the audio thread for the head, a worker or the audio thread for the rest
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<std::vector<Complex>> delayLines;
+        std::vector<std::vector<float>> outputs;
+        std::vector<float> fftBuffer, fadeBuffer;
+        std::vector<Complex> accumulator;
+        int delayLineIndex{ 0 };
+        bool hasKernel{ false };
+        //the resetPosition the delay lines were last cleared for
+        juce::int64 appliedReset{ 0 };
+
+        //setImpulseResponse() side
+        std::unique_ptr<juce::dsp::FFT> designFft;
+        std::vector<float> designScratch;
+
+        TripleBuffer<std::vector<Complex>> kernels;
+
+        //written before numPosted is released, read after it's acquired
+        std::array<std::atomic<juce::int64>, numOutputSlots> deadlines{};
+        std::atomic<int> numPosted{ 0 }, numCompleted{ 0 };
+        //blocks before this one have been played, they are skipped rather than computed
+        std::atomic<int> numExpired{ 0 };
+        std::atomic<bool> busy{ false };
+
+        //audio thread, the last blocks counted as late and as dropped
+        int lastLateIndex{ -1 }, lastDroppedIndex{ -1 };
+    };
+
+    bool tryClaim(Segment& segment) noexcept;
+    void release(Segment& segment) noexcept;
+
+    //with the segment claimed: computes the next block, or skips it if it has expired, and marks it completed
+    void completeBlock(Segment& segment, int index) noexcept;
+    //computes block index of a segment into its output slot
+    void computeBlock(Segment& segment, int index) noexcept;
+    //keeps the delay line in step for a block that isn't computed
+    void skipBlock(Segment& segment) noexcept;
+    void convolve(Segment& segment, int channel, const std::vector<Complex>& kernel, float* destination) noexcept;
+    void processHeadBlock() noexcept;
+
+    //worker side: the earliest deadline among pending tail blocks, or false if there are none
+    bool getEarliestDeadline(juce::int64& deadline, int& segmentIndex) const noexcept;
+    //worker side: computes the next pending block of that segment unless someone else is on it
+    bool runPendingBlock(int segmentIndex) noexcept;
+
+    juce::SharedResourcePointer<ConvolutionWorkers> workers;
+
+    int numChannels{ 0 }, headSize{ 0 };
+    std::vector<std::unique_ptr<Segment>> segments;
+    //message thread
+    bool active{ false };
+
+    //audio thread: input history long enough for a block of the largest segment to be computed a few blocks late
+    std::vector<std::vector<float>> history;
+    std::vector<std::vector<float>> output;
+    int historyMask{ 0 }, fill{ 0 };
+    //never goes back, so blocks posted before a reset() can still be told apart from the ones after it
+    juce::int64 position{ 0 };
+    //input before this position reads as silence
+    std::atomic<juce::int64> resetPosition{ 0 };
+
+    std::atomic<bool> nonRealtime{ false };
+    std::atomic<int> numLateBlocks{ 0 }, numDroppedBlocks{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
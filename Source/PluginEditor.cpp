@@ -172,17 +172,15 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 //==============================================================================
 
-ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p): audioProcessor(p)
+ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p): audioProcessor(p), chainParameters(p.apvts)
 {
     //listen to apvts param updates
     const auto& params = audioProcessor.getParameters();
     for (auto param : params) {
         param->addListener(this);
     }
-    //persisted values
-    updateChain();
-    //Atomic var boolean check timer
-    startTimerHz(60);
+    //opaque, the background image covers everything
+    setOpaque(true);
 }
 ResponseCurveComponent::~ResponseCurveComponent()
 {
@@ -191,118 +189,308 @@ ResponseCurveComponent::~ResponseCurveComponent()
     for (auto param : params) {
         param->removeListener(this);
     }
+    stopTimer();
+    //the analyzer's callback marks this component dirty
+    audioProcessor.spectrumAnalyzer.stop();
+    //waits for a render in progress, after this renderCurve() is never called again
+    renderThread->removeClient(*this);
+    cancelPendingUpdate();
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue) {
-    parametersChanged.set(true);
+    //may be the audio thread, which mustn't wake the render thread; the timer does that
+    parametersChanged = true;
+}
+
+void ResponseCurveComponent::handleAsyncUpdate() {
+    repaint();
 }
 
 void ResponseCurveComponent::timerCallback() {
-    if (parametersChanged.compareAndSetBool(false, true)) {
-        //update monochain
-        updateChain();
+    if (parametersChanged.exchange(false))
+        renderThread->markDirty(*this);
+}
 
-        //signal a repaint of responseCurve
-        repaint();
-    }
+void ResponseCurveComponent::visibilityChanged() {
+    updateRenderRegistration();
 }
 
-void ResponseCurveComponent::updateChain() {
+void ResponseCurveComponent::parentHierarchyChanged() {
+    updateRenderRegistration();
+}
+
+void ResponseCurveComponent::updateRenderRegistration() {
+    const auto shouldRender = isShowing();
 
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
+    if (shouldRender == registeredForRendering)
+        return;
 
-    //peak 
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    registeredForRendering = shouldRender;
+
+    if (shouldRender)
+    {
+        //anything that changed while it was hidden
+        if (parametersChanged.exchange(false))
+            dirty = true;
 
-    //cut filters
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCutFilter(monoChain.get < ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+        renderThread->addClient(*this);
+        audioProcessor.spectrumAnalyzer.start([this] { renderThread->markDirty(*this); });
+        startTimerHz(refreshRateHz);
+    }
+    else
+    {
+        stopTimer();
+        audioProcessor.spectrumAnalyzer.stop();
+        renderThread->removeClient(*this);
+        hasSpectrum = false;
+    }
 }
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
+void ResponseCurveComponent::resized()
 {
     using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll(Colours::black);
-
-    auto responseArea = getLocalBounds();
-    auto width = responseArea.getWidth();
-
-    //get chain elements
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
-
-    auto sampleRate = audioProcessor.getSampleRate();
-
-    std::vector<double> mags;
-    //preallocate space 
-    mags.resize(width);
-
-    //calculate magnittude for each pixel
-    for (int i = 0; i < width; ++i) {
-        double mag = 1.f;
-
-        //map normalised pixel number to its frequency in human hearing range
-        auto freq = mapToLog10(double(i) / double(width), 20.0, 20'000.0);
-        //get magnitude for pixel frequency if the band is not bypassed
-        //peak filter
-        if (!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        //lowCut filter
-        if (!lowCut.isBypassed<0>())
-            mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<1>())
-            mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<2>())
-            mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<3>())
-            mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        //highCut filter
-        if (!highCut.isBypassed<0>())
-            mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<1>())
-            mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<2>())
-            mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<3>())
-            mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        //convert mag to decibels and store
-        mags[i] = Decibels::gainToDecibels(mag);
+
+    const auto scale = Component::getApproximateScaleFactorForComponent(this);
+    const auto width = roundToInt(getWidth() * scale);
+    const auto height = roundToInt(getHeight() * scale);
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    //static layer at physical resolution
+    background = Image(Image::RGB, width, height, true);
+    {
+        Graphics g(background);
+        g.addTransform(AffineTransform::scale(scale));
+        g.fillAll(Colours::black);
+
+        //orange border
+        g.setColour(Colours::orange);
+        g.drawRoundedRectangle(getLocalBounds().toFloat(), 4.f, 1.f);
     }
 
+    imageWidth = width;
+    imageHeight = height;
+    imageScale = scale;
+
+    if (registeredForRendering)
+        renderThread->markDirty(*this);
+    else
+        dirty = true;
+}
+
+void ResponseCurveComponent::renderCurve()
+{
+    using namespace juce;
+
+    const auto width = imageWidth.load();
+    const auto height = imageHeight.load();
+    const auto sampleRate = audioProcessor.getSampleRate();
+
+    //not prepared yet, there is nothing to design for
+    if (width <= 0 || height <= 0 || sampleRate <= 0.0)
+        return;
+
+    //peak and cut filters, then re-evaluate only the bands whose coefficients moved
+    makeChainCoefficients(chainCoefficients, chainParameters.load(), sampleRate);
+    responseEvaluator.setGrid(width, sampleRate);
+    responseEvaluator.update(chainCoefficients);
+
+    //magnitude in decibels for each physical pixel column
+    const auto* mags = responseEvaluator.getDecibels();
+    const auto numMags = responseEvaluator.getNumPoints();
+
     //build path
     Path responseCurve;
 
-    //min and max window positions
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-
-    //map decibel mag to responseArea
-    auto map = [outputMin, outputMax](double input) {
-        return jmap<double>(input, -24, 24, outputMin, outputMax);
+    //map decibel mag to the image
+    auto map = [height](double input) {
+        return jmap<double>(input, -24, 24, height, 0);
         };
 
     //start new sub-path from left edge with the first magnitude
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    responseCurve.startNewSubPath(0, map(mags[0]));
     //create line-tos for every other magnitude
-    for (size_t i = 1; i < mags.size(); ++i) {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+    for (int i = 1; i < numMags; ++i) {
+        responseCurve.lineTo(i, map(mags[i]));
     };
 
-    //orange border
-    g.setColour(Colours::orange);
-    g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
+    //newest spectra, if the analyzer has produced any
+    if (audioProcessor.spectrumAnalyzer.acquire())
+    {
+        spectrum = audioProcessor.spectrumAnalyzer.getFrame();
+        hasSpectrum = true;
+    }
+
+    //software image, safe to draw into off the message thread
+    Image image(Image::ARGB, width, height, true, SoftwareImageType());
+    {
+        Graphics g(image);
+
+        if (hasSpectrum)
+        {
+            auto makeSpectrumPath = [width, height](const std::array<float, SpectrumFrame::numBins>& bins) {
+                Path path;
+                const auto binWidth = (float)width / SpectrumFrame::numBins;
+
+                for (int i = 0; i < SpectrumFrame::numBins; ++i) {
+                    //-96 dBFS at the bottom edge, 0 dBFS at the top
+                    const auto x = (i + 0.5f) * binWidth;
+                    const auto y = jmap(bins[(size_t)i], -96.f, 0.f, (float)height, 0.f);
+
+                    if (i == 0)
+                        path.startNewSubPath(x, y);
+                    else
+                        path.lineTo(x, y);
+                }
+                return path;
+                };
+
+            g.setColour(Colours::grey.withAlpha(0.6f));
+            g.strokePath(makeSpectrumPath(spectrum.pre), PathStrokeType(imageScale.load()));
+
+            g.setColour(Colours::skyblue.withAlpha(0.8f));
+            g.strokePath(makeSpectrumPath(spectrum.post), PathStrokeType(imageScale.load()));
+        }
+
+        g.setColour(Colours::white);
+        g.strokePath(responseCurve, PathStrokeType(2.f * imageScale.load()));
+    }
+
+    {
+        const SpinLock::ScopedLockType sl(curveImageLock);
+        std::swap(curveImage, image);
+    }
 
-    //draw response curve path
-    g.setColour(Colours::white);
-    g.strokePath(responseCurve, PathStrokeType(2.f));
+    triggerAsyncUpdate();
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    auto bounds = getLocalBounds().toFloat();
+
+    if (background.isValid())
+        g.drawImage(background, bounds);
+    else
+        g.fillAll(Colours::black);
+
+    Image curve;
+    {
+        const SpinLock::ScopedLockType sl(curveImageLock);
+        curve = curveImage;
+    }
+
+    //draw response curve
+    if (curve.isValid())
+        g.drawImage(curve, bounds);
+}
+
+//==============================================================================
+
+ControlAttachment::ControlAttachment(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Slider& sliderToUse)
+    : parameter(*apvts.getParameter(parameterID)), slider(&sliderToUse)
+{
+    //the slider takes the parameter's range, skew, snapping and text, as with SliderParameterAttachment
+    const auto range = parameter.getNormalisableRange();
+
+    auto convertFrom0To1 = [range](double start, double end, double normalised) mutable {
+        range.start = (float)start;
+        range.end = (float)end;
+        return (double)range.convertFrom0to1((float)normalised);
+    };
+    auto convertTo0To1 = [range](double start, double end, double value) mutable {
+        range.start = (float)start;
+        range.end = (float)end;
+        return (double)range.convertTo0to1((float)value);
+    };
+    auto snapToLegalValue = [range](double start, double end, double value) mutable {
+        range.start = (float)start;
+        range.end = (float)end;
+        return (double)range.snapToLegalValue((float)value);
+    };
+
+    juce::NormalisableRange<double> sliderRange{ (double)range.start, (double)range.end,
+                                                 std::move(convertFrom0To1), std::move(convertTo0To1), std::move(snapToLegalValue) };
+    sliderRange.interval = range.interval;
+    sliderRange.skew = range.skew;
+    sliderRange.symmetricSkew = range.symmetricSkew;
+    slider->setNormalisableRange(sliderRange);
+
+    auto& rap = parameter;
+    slider->valueFromTextFunction = [&rap](const juce::String& text) { return (double)rap.convertFrom0to1(rap.getValueForText(text)); };
+    slider->textFromValueFunction = [&rap](double value) { return rap.getText(rap.convertTo0to1((float)value), 0); };
+    slider->setDoubleClickReturnValue(true, range.convertFrom0to1(parameter.getDefaultValue()));
+
+    timerCallback();
+    slider->addListener(this);
+    startTimerHz(refreshRateHz);
+}
+
+ControlAttachment::ControlAttachment(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Button& buttonToUse)
+    : parameter(*apvts.getParameter(parameterID)), button(&buttonToUse)
+{
+    timerCallback();
+    button->addListener(this);
+    startTimerHz(refreshRateHz);
+}
+
+ControlAttachment::~ControlAttachment()
+{
+    stopTimer();
+
+    if (slider != nullptr)
+        slider->removeListener(this);
+
+    if (button != nullptr)
+        button->removeListener(this);
+}
+
+void ControlAttachment::sliderValueChanged(juce::Slider*) {
+    if (ignoreCallbacks)
+        return;
+
+    const auto value = parameter.convertTo0to1((float)slider->getValue());
+
+    if (value != parameter.getValue())
+        parameter.setValueNotifyingHost(value);
+}
+
+void ControlAttachment::sliderDragStarted(juce::Slider*) {
+    parameter.beginChangeGesture();
+}
+
+void ControlAttachment::sliderDragEnded(juce::Slider*) {
+    parameter.endChangeGesture();
+}
+
+void ControlAttachment::buttonClicked(juce::Button*) {
+    if (ignoreCallbacks)
+        return;
+
+    //a click is a whole gesture
+    parameter.beginChangeGesture();
+    parameter.setValueNotifyingHost(button->getToggleState() ? 1.f : 0.f);
+    parameter.endChangeGesture();
+}
+
+void ControlAttachment::timerCallback() {
+    const auto value = parameter.getValue();
+
+    if (value == shownValue)
+        return;
+
+    shownValue = value;
+
+    //with a synchronous notification, like JUCE's attachments, so the control's own callbacks see the change
+    const juce::ScopedValueSetter<bool> ignore(ignoreCallbacks, true);
+
+    if (slider != nullptr)
+        slider->setValue(parameter.convertFrom0to1(value), juce::sendNotificationSync);
+
+    if (button != nullptr)
+        button->setToggleState(value >= 0.5f, juce::sendNotificationSync);
 }
 
 //==============================================================================
@@ -323,7 +511,13 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
     highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
     lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-    highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider)
+    highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
+    linearPhaseButtonAttachment(audioProcessor.apvts, "Linear Phase", linearPhaseButton),
+    snapshotMorphButtonAttachment(audioProcessor.apvts, "Snapshot Morph", snapshotMorphButton),
+    morphSliderAttachment(audioProcessor.apvts, "Morph", morphSlider)
+   #if SIMPLEEQ_PROBES
+    , profilerOverlay(audioProcessor.probes)
+   #endif
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -354,6 +548,27 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
         addAndMakeVisible(comp);
     }
 
+    for (int slot = 0; slot < SnapshotMorph::numSlots; ++slot) {
+        auto& button = snapshotButtons[(size_t)slot];
+        button.setButtonText(juce::String::charToString((juce::juce_wchar)('A' + slot)));
+        button.setTooltip("click: recall, shift-click: store, alt-click: clear");
+        button.onClick = [this, slot] { snapshotButtonClicked(slot); };
+        addAndMakeVisible(button);
+    }
+
+    updateSnapshotButtons();
+
+    //the attachment sets the toggle state with a click notification too, so this follows the host
+    linearPhaseButton.onClick = [this] { updateMorphAvailability(); };
+    updateMorphAvailability();
+
+   #if SIMPLEEQ_PROBES
+    //above the response curve, hidden until toggled on
+    profilerButton.onClick = [this] { profilerOverlay.setVisible(profilerButton.getToggleState()); };
+    addAndMakeVisible(profilerButton);
+    addChildComponent(profilerOverlay);
+   #endif
+
     setSize (600, 480);
 }
 
@@ -381,9 +596,27 @@ void SimpleEQAudioProcessorEditor::resized()
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
     responseCurveComponent.setBounds(responseArea);
 
+   #if SIMPLEEQ_PROBES
+    profilerOverlay.setBounds(responseArea);
+   #endif
+
     //padding
     bounds.removeFromTop(5);
 
+    //mode switch and snapshot morphing
+    auto modeArea = bounds.removeFromTop(24);
+    linearPhaseButton.setBounds(modeArea.removeFromLeft(120));
+
+   #if SIMPLEEQ_PROBES
+    profilerButton.setBounds(modeArea.removeFromLeft(80));
+   #endif
+
+    for (auto it = snapshotButtons.rbegin(); it != snapshotButtons.rend(); ++it)
+        it->setBounds(modeArea.removeFromRight(28).reduced(2));
+
+    snapshotMorphButton.setBounds(modeArea.removeFromLeft(80));
+    morphSlider.setBounds(modeArea);
+
     //sliders
     auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
     auto highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
@@ -399,6 +632,38 @@ void SimpleEQAudioProcessorEditor::resized()
     peakQualitySlider.setBounds(bounds);
 }
 
+void SimpleEQAudioProcessorEditor::snapshotButtonClicked(int slot)
+{
+    const auto modifiers = juce::ModifierKeys::getCurrentModifiers();
+
+    if (modifiers.isShiftDown())
+        audioProcessor.storeSnapshot(slot);
+    else if (modifiers.isAltDown())
+        audioProcessor.clearSnapshot(slot);
+    else
+        audioProcessor.recallSnapshot(slot);
+
+    updateSnapshotButtons();
+}
+
+void SimpleEQAudioProcessorEditor::updateSnapshotButtons()
+{
+    //lit while the slot holds a snapshot
+    for (int slot = 0; slot < SnapshotMorph::numSlots; ++slot)
+        snapshotButtons[(size_t)slot].setToggleState(audioProcessor.hasSnapshot(slot), juce::dontSendNotification);
+}
+
+void SimpleEQAudioProcessorEditor::updateMorphAvailability()
+{
+    const auto available = !linearPhaseButton.getToggleState();
+    const auto tooltip = available ? juce::String() : juce::String("Morph has no effect in linear phase");
+
+    snapshotMorphButton.setEnabled(available);
+    snapshotMorphButton.setTooltip(tooltip);
+    morphSlider.setEnabled(available);
+    morphSlider.setTooltip(tooltip);
+}
+
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
     return{
         &peakFreqSlider,
@@ -409,5 +674,8 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
          &lowCutSlopeSlider,
          &highCutSlopeSlider,
          &responseCurveComponent,
+         &linearPhaseButton,
+         &snapshotMorphButton,
+         &morphSlider,
     };
 };
@@ -10,9 +10,27 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ResponseEvaluator.h"
+#include "CurveRenderThread.h"
+#include "ProfilerOverlay.h"
 
+/**
+    The chain's magnitude response.
+
+    The curve is rendered into an image on the shared CurveRenderThread, so
+    paint() only blits the cached background and curve images. Parameter
+    listeners can run on the audio thread, where waking a thread takes a
+    lock, so they only set a flag. A timer on the message thread hands it to
+    the render thread, so idle parameters cost a flag check per frame and
+    never a render. While the component isn't showing the timer is stopped
+    and it isn't registered with the thread at all.
+
+    The processor's pre- and post-EQ spectra are drawn behind the curve. The
+    analyzer runs only while the component is showing and wakes the render
+    thread with each new frame.
+*/
 struct ResponseCurveComponent :juce::Component, juce::AudioProcessorParameter::Listener,
-    juce::Timer 
+    juce::AsyncUpdater, juce::Timer, CurveRenderThread::Client
 {
     ResponseCurveComponent(SimpleEQAudioProcessor&);
     ~ResponseCurveComponent();
@@ -21,19 +39,54 @@ struct ResponseCurveComponent :juce::Component, juce::AudioProcessorParameter::L
     void parameterValueChanged(int parameterIndex, float newValue) override;
     void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {}; //EMPTY IMPLEMENTATION
 
-    //juce::Timer override
+    //juce::AsyncUpdater override, repaints once a new curve image is ready
+    void handleAsyncUpdate() override;
+
+    //juce::Timer override, passes parameter changes on to the render thread
     void timerCallback() override;
 
+    //CurveRenderThread::Client override, called on the render thread
+    void renderCurve() override;
+
     void paint(juce::Graphics&) override;
+    void resized() override;
+
+    //juce::Component overrides, render only while on screen
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
 private:
     SimpleEQAudioProcessor& audioProcessor;
-    MonoChain monoChain;
 
-    void updateChain();
+    juce::SharedResourcePointer<CurveRenderThread> renderThread;
+    //message thread
+    bool registeredForRendering{ false };
+    //set by the parameter listener on any thread, taken by the timer
+    std::atomic<bool> parametersChanged{ false };
+
+    //matches the display, so a change is drawn on the next frame or the one after
+    static constexpr int refreshRateHz = 60;
+
+    void updateRenderRegistration();
 
-    juce::Atomic<bool> parametersChanged{ false };
-    
+    //render thread only
+    ChainParameters chainParameters;
+    ChainCoefficients chainCoefficients;
+    //per-pixel response, cached per band
+    ResponseEvaluator responseEvaluator;
+    SpectrumFrame spectrum;
+    bool hasSpectrum{ false };
+
+    //curve image size in physical pixels and the scale to logical ones, set on the message thread
+    std::atomic<int> imageWidth{ 0 }, imageHeight{ 0 };
+    std::atomic<float> imageScale{ 1.f };
+
+    //the last rendered curve, swapped in by the render thread
+    juce::SpinLock curveImageLock;
+    juce::Image curveImage;
+
+    //black fill and border, redrawn only on resize
+    juce::Image background;
 };
 //==============================================================================
 
@@ -79,6 +132,50 @@ private:
     LookAndFeel lnf;
 };
 
+//==============================================================================
+/**
+    Keeps a slider or button and a parameter in step, like the APVTS
+    attachments, without listening to the parameter.
+
+    JUCE's attachments are parameter listeners, so host automation calls them
+    on the audio thread, where they post a message to the message thread: a
+    lock and possibly an allocation in the host's callback. This one reads
+    the parameter on a message-thread timer instead, the way
+    ResponseCurveComponent picks up its changes, so the audio thread never
+    sees the editor's controls. Changes the user makes go to the parameter
+    as gestures, as before.
+*/
+class ControlAttachment : private juce::Slider::Listener, private juce::Button::Listener, private juce::Timer
+{
+public:
+    ControlAttachment(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Slider& slider);
+    ControlAttachment(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Button& button);
+    ~ControlAttachment() override;
+
+private:
+    void sliderValueChanged(juce::Slider*) override;
+    void sliderDragStarted(juce::Slider*) override;
+    void sliderDragEnded(juce::Slider*) override;
+    void buttonClicked(juce::Button*) override;
+
+    //shows the parameter's value on the control if it has changed since the last look
+    void timerCallback() override;
+
+    juce::RangedAudioParameter& parameter;
+    juce::Slider* slider{ nullptr };
+    juce::Button* button{ nullptr };
+
+    //normalised, the value the control last showed
+    float shownValue{ -1.f };
+    //set while the timer moves the control, so the move isn't sent back to the parameter
+    bool ignoreCallbacks{ false };
+
+    //often enough that automation looks continuous
+    static constexpr int refreshRateHz = 30;
+
+    JUCE_DECLARE_NON_COPYABLE(ControlAttachment)
+};
+
 //==============================================================================
 /**
 */
@@ -107,9 +204,28 @@ private:
 
     ResponseCurveComponent responseCurveComponent;
 
-    //attachment aliases
-    using APVTS = juce::AudioProcessorValueTreeState;
-    using Attachment = APVTS::SliderAttachment;
+    juce::ToggleButton linearPhaseButton{ "Linear Phase" };
+
+    //morph through the A/B/C/D snapshots; shift-click a slot stores, alt-click clears, click recalls
+    juce::ToggleButton snapshotMorphButton{ "Morph" };
+    juce::Slider morphSlider{ juce::Slider::LinearHorizontal, juce::Slider::NoTextBox };
+    std::array<juce::TextButton, SnapshotMorph::numSlots> snapshotButtons;
+    //shows the snapshot and Morph tooltips
+    juce::TooltipWindow tooltipWindow{ this };
+
+    void snapshotButtonClicked(int slot);
+    void updateSnapshotButtons();
+    //the linear-phase FIR follows the parameters only, so Morph is greyed out while it's on
+    void updateMorphAvailability();
+
+   #if SIMPLEEQ_PROBES
+    //callback timings over the response curve, the processor only records while they're showing
+    juce::ToggleButton profilerButton{ "Profile" };
+    ProfilerOverlay profilerOverlay;
+   #endif
+
+    //attachment alias
+    using Attachment = ControlAttachment;
 
     //slider Attachments
     Attachment peakFreqSliderAttachment, 
@@ -120,6 +236,9 @@ private:
         lowCutSlopeSliderAttachment, 
         highCutSlopeSliderAttachment;
 
+    Attachment linearPhaseButtonAttachment, snapshotMorphButtonAttachment;
+    Attachment morphSliderAttachment;
+
     //helper to get editor components in a vec
     std::vector<juce::Component*> getComps();
 
@@ -22,10 +22,19 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    coefficientDesigner.setListener(this);
+
+    //listen to every parameter so only the bands that changed get redesigned
+    for (auto* param : getParameters())
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.addParameterListener(rap->getParameterID(), this);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* param : getParameters())
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.removeParameterListener(rap->getParameterID(), this);
 }
 
 //==============================================================================
@@ -63,7 +72,15 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return 0.0;
+
+    if (isLinearPhase())
+        return linearPhaseEngine.getTailSamples() / sampleRate;
+
+    return cascadeTailSamples.load(std::memory_order_relaxed) / sampleRate;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -96,22 +113,71 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    //create spec
-    juce::dsp::ProcessSpec spec;
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        filterEngine.setTopology(band, bandTopologies[(size_t)band]);
+        doubleFilterEngine.setTopology(band, bandTopologies[(size_t)band]);
+    }
+
+    filterEngine.prepare(getTotalNumInputChannels(), sampleRate);
+    doubleFilterEngine.prepare(getTotalNumInputChannels(), sampleRate);
+
+    if (isUsingDoublePrecision())
+        floatScratch.setSize(getTotalNumInputChannels(), samplesPerBlock);
+    else
+        floatScratch.setSize(0, 0);
+
+    linearPhaseEngine.prepare(getTotalNumInputChannels(), sampleRate, samplesPerBlock);
+    spectrumAnalyzer.setSampleRate(sampleRate);
+    snapshotMorph.setSampleRate(sampleRate);
+
+    //new sample rate, design every band synchronously before playback starts
+    coefficientDesigner.prepare(sampleRate);
+    updateFilters(true);
+    wasMorphing = false;
+    applyLinearPhaseMode();
+}
+
+void SimpleEQAudioProcessor::setControlInterval(int numSamples)
+{
+    filterEngine.setControlInterval(numSamples);
+    doubleFilterEngine.setControlInterval(numSamples);
+}
 
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+int SimpleEQAudioProcessor::getControlInterval() const
+{
+    return filterEngine.getControlInterval();
+}
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+void SimpleEQAudioProcessor::setBandTopology(ChainPositions band, CascadeTopology topology)
+{
+    bandTopologies[(size_t)band] = topology;
+}
 
-    updateFilters();
+CascadeTopology SimpleEQAudioProcessor::getBandTopology(ChainPositions band) const
+{
+    return bandTopologies[(size_t)band];
 }
 
 void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner.release();
+    linearPhaseEngine.setActive(false);
+}
+
+void SimpleEQAudioProcessor::reset()
+{
+    filterEngine.reset();
+    doubleFilterEngine.reset();
+    linearPhaseEngine.reset();
+}
+
+void SimpleEQAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    linearPhaseEngine.setNonRealtime(isNonRealtime);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -121,12 +187,9 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel runs through the same cascade, so anything from mono
+    // to immersive and ambisonic layouts is fine as long as there is one.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -140,8 +203,23 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
 {
+   #if SIMPLEEQ_PROBES
+    const auto probeStart = probes.beginCallback();
+   #endif
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -155,21 +233,101 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
-
-    juce::dsp::AudioBlock<float> block(buffer);
+    //offline, the block takes the automation that arrived before it rather than whatever the designer thread
+    //has got round to; in real time that wait would be a lock and a design on the audio thread
+    if (isNonRealtime())
+        coefficientDesigner.designDirtyBands();
+
+    //the FIR follows the parameters only, so morphing is an IIR-only feature; the editor greys it out
+    const auto morphing = !isLinearPhase() && snapshotMorphParameter->load() > 0.5f && snapshotMorph.prepareBlock();
+
+    //the designer's sets are left waiting until the morph lets go
+    const auto bandsRedesigned = morphing ? applyMorph(!wasMorphing) : updateFilters(wasMorphing);
+
+    wasMorphing = morphing;
+
+    constexpr auto isFloat = std::is_same_v<SampleType, float>;
+
+    //the analyzer and the FIR only take float, the double path hands them a copy
+    auto asFloat = [this, &buffer]() -> const juce::AudioBuffer<float>&
+    {
+        if constexpr (isFloat)
+            return buffer;
+        else
+        {
+            floatScratch.makeCopyOf(buffer, true);
+            return floatScratch;
+        }
+    };
+
+    //only while an editor is showing the spectrum
+    const auto analyzing = spectrumAnalyzer.isRunning();
+
+    if (analyzing)
+        spectrumAnalyzer.pushPre(asFloat());
+
+    auto& engine = [this]() -> CascadeEngine<SampleType>&
+    {
+        if constexpr (isFloat)
+            return filterEngine;
+        else
+            return doubleFilterEngine;
+    }();
+
+    const auto linearPhase = isLinearPhase();
+
+    //the engine switched to still holds whatever it saw when it was last used
+    if (linearPhase != wasLinearPhase)
+    {
+        if (linearPhase)
+            linearPhaseEngine.reset();
+        else
+            engine.reset();
+
+        wasLinearPhase = linearPhase;
+        silentSamples = 0;
+    }
 
-    //extract channels from block
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    if (linearPhase)
+    {
+        //the cascade spots silence by itself, the FIR is skipped once it has flushed everything it heard
+        const auto numSamples = buffer.getNumSamples();
+        const auto silent = buffer.getMagnitude(0, numSamples) == SampleType(0);
+        const auto flushed = silent && silentSamples >= linearPhaseEngine.getTailSamples();
+        silentSamples = silent ? juce::jmin(silentSamples + numSamples, std::numeric_limits<int>::max() / 2) : 0;
+
+        if (!flushed)
+        {
+            if constexpr (isFloat)
+            {
+                juce::dsp::AudioBlock<float> block(buffer);
+                linearPhaseEngine.process(block);
+            }
+            else
+            {
+                //the FIR's own rounding is far below its truncation, so it stays in float
+                floatScratch.makeCopyOf(buffer, true);
+                juce::dsp::AudioBlock<float> block(floatScratch);
+                linearPhaseEngine.process(block);
+                buffer.makeCopyOf(floatScratch, true);
+            }
+        }
+    }
+    else
+    {
+        //every channel runs through the same cascade in one pass
+        engine.process(juce::dsp::AudioBlock<SampleType>(buffer));
+    }
 
-    //create ProcessContexts that wrap each individual AudioBlock
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if (analyzing)
+        spectrumAnalyzer.pushPost(asFloat());
 
-    //pass ProcessContexts to MonoChain Filters
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+   #if SIMPLEEQ_PROBES
+    probes.endCallback(probeStart, getSampleRate(), buffer.getNumSamples(),
+                       linearPhase ? 0 : engine.getNumBandsProcessed(), bandsRedesigned);
+   #else
+    juce::ignoreUnused(bandsRedesigned);
+   #endif
 }
 
 //==============================================================================
@@ -194,7 +352,7 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     //memory output stream that writes to a memory block
     juce::MemoryOutputStream mos(destData, true);
 
-    apvts.state.writeToStream(mos);
+    PresetFormat::write(createPreset(), mos);
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -202,81 +360,234 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
 
+    if (PresetFormat::isPreset(data, (size_t)sizeInBytes))
+    {
+        PresetData preset;
+
+        if (PresetFormat::read(data, (size_t)sizeInBytes, preset))
+            applyPreset(preset);
+
+        return;
+    }
+
+    //state saved before the binary format
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     //valid?
     if (tree.isValid()) {
-        //replace plugin state and update Filters
+        //replace plugin state and let the designer thread redesign the Filters
         apvts.replaceState(tree);
-        updateFilters();
+        coefficientDesigner.markAllDirty();
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+PresetData SimpleEQAudioProcessor::createPreset() const
+{
+    PresetData preset;
+
+    for (auto* param : getParameters())
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+            preset.parameters.emplace_back(rap->getParameterID(), apvts.getRawParameterValue(rap->getParameterID())->load());
+
+    //so a recall at any common rate needs no design work
+    PresetFormat::addCoefficientSets(preset, chainParameters.load(), getSampleRate());
+
+    for (int slot = 0; slot < SnapshotMorph::numSlots; ++slot)
+    {
+        ChainSettings settings;
+
+        if (snapshotMorph.getSnapshot(slot, settings))
+            preset.snapshots.emplace_back(slot, settings);
+    }
+
+    return preset;
+}
+
+void SimpleEQAudioProcessor::applyPreset(const PresetData& preset)
+{
+    //snapshots aren't parameters, a preset replaces all of them
+    snapshotMorph.clearAllSnapshots();
+
+    for (auto& snapshot : preset.snapshots)
+        if (juce::isPositiveAndBelow(snapshot.first, SnapshotMorph::numSlots))
+            snapshotMorph.setSnapshot(snapshot.first, snapshot.second);
+
+    //hand the stored set straight to the audio thread, the designer then finds nothing to do
     ChainSettings settings;
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    
-    return settings;
+    if (preset.getChainSettings(settings))
+        if (const auto* chainCoefficients = preset.findCoefficients(getSampleRate(), settings))
+            coefficientDesigner.publishPrecomputed(*chainCoefficients, settings);
+
+    //parameters the preset doesn't know about go back to their defaults
+    for (auto* param : getParameters())
+    {
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+        {
+            const auto* value = preset.findParameter(rap->getParameterID());
+            rap->setValueNotifyingHost(value != nullptr ? rap->convertTo0to1(*value) : rap->getDefaultValue());
+        }
+    }
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+bool SimpleEQAudioProcessor::loadPreset(const PresetBank& bank, int index)
+{
+    PresetData preset;
+
+    if (!bank.getPreset(index, preset))
+        return false;
+
+    applyPreset(preset);
+    return true;
+}
+
+void SimpleEQAudioProcessor::storeSnapshot(int slot)
+{
+    snapshotMorph.setSnapshot(slot, chainParameters.load());
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+bool SimpleEQAudioProcessor::recallSnapshot(int slot)
+{
+    ChainSettings settings;
+
+    if (!snapshotMorph.getSnapshot(slot, settings))
+        return false;
+
+    auto setParameter = [this](const juce::String& parameterID, float value)
+    {
+        auto* parameter = apvts.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    setParameter("LowCut Freq", settings.lowCutFreq);
+    setParameter("HighCut Freq", settings.highCutFreq);
+    setParameter("Peak Freq", settings.peakFreq);
+    setParameter("Peak Gain", settings.peakGainInDecibels);
+    setParameter("Peak Quality", settings.peakQuality);
+    setParameter("LowCut Slope", (float)settings.lowCutSlope);
+    setParameter("HighCut Slope", (float)settings.highCutSlope);
+
+    return true;
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements) {
-    *old = *replacements;
+void SimpleEQAudioProcessor::clearSnapshot(int slot)
+{
+    snapshotMorph.clearSnapshot(slot);
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+bool SimpleEQAudioProcessor::hasSnapshot(int slot) const
 {
-    //get coefficients based on order
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    return snapshotMorph.hasSnapshot(slot);
+}
 
-    //both channels
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainCoefficients& chainCoefficients) {
+    withFilterEngine([&](auto& engine) { engine.setPeak(chainCoefficients.peak, chainCoefficients.peakSvf); });
+}
 
-    //update coefficients
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+void SimpleEQAudioProcessor::updateLowCutFilters(const ChainCoefficients& chainCoefficients)
+{
+    withFilterEngine([&](auto& engine) { engine.setLowCut(chainCoefficients.lowCut, chainCoefficients.lowCutSvf, chainCoefficients.lowCutSlope); });
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+void SimpleEQAudioProcessor::updateHighCutFilters(const ChainCoefficients& chainCoefficients)
 {
-    //get coefficients
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    withFilterEngine([&](auto& engine) { engine.setHighCut(chainCoefficients.highCut, chainCoefficients.highCutSvf, chainCoefficients.highCutSlope); });
+}
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+int SimpleEQAudioProcessor::updateFilters(bool reloadAll)
+{
+    //wait-free pickup of whatever the designer thread published last
+    if (!coefficientDesigner.acquire() && !reloadAll)
+        return 0;
+
+    const auto& chainCoefficients = coefficientDesigner.getCoefficients();
+    const auto& versions = chainCoefficients.bandVersions;
+    int bandsLoaded = 0;
+
+    //only touch the bands that were redesigned since the last set we loaded
+    if (reloadAll || versions[ChainPositions::LowCut] != appliedBandVersions[ChainPositions::LowCut])
+    {
+        updateLowCutFilters(chainCoefficients);
+        ++bandsLoaded;
+    }
+    if (reloadAll || versions[ChainPositions::Peak] != appliedBandVersions[ChainPositions::Peak])
+    {
+        updatePeakFilter(chainCoefficients);
+        ++bandsLoaded;
+    }
+    if (reloadAll || versions[ChainPositions::HighCut] != appliedBandVersions[ChainPositions::HighCut])
+    {
+        updateHighCutFilters(chainCoefficients);
+        ++bandsLoaded;
+    }
+
+    appliedBandVersions = versions;
+    return bandsLoaded;
+}
+
+int SimpleEQAudioProcessor::applyMorph(bool force)
+{
+    //a table lookup and a blend, never a redesign; the engine glides to it like any other update
+    if (!snapshotMorph.getCoefficients(morphParameter->load(), morphCoefficients, force))
+        return 0;
+
+    updateLowCutFilters(morphCoefficients);
+    updatePeakFilter(morphCoefficients);
+    updateHighCutFilters(morphCoefficients);
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    return 3;
 }
 
-void SimpleEQAudioProcessor::updateFilters()
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
-    auto chainSettings = getChainSettings(apvts);
+    juce::ignoreUnused(newValue);
+
+    if (parameterID.startsWith("LowCut"))
+        coefficientDesigner.markDirty(ChainPositions::LowCut);
+    else if (parameterID.startsWith("Peak"))
+        coefficientDesigner.markDirty(ChainPositions::Peak);
+    else if (parameterID.startsWith("HighCut"))
+        coefficientDesigner.markDirty(ChainPositions::HighCut);
+    else if (parameterID == "Linear Phase")
+    {
+        //this can be the audio thread, so both the FIR and the latency are left to the designer thread:
+        //the FIR is only kept up to date while it's in use, so it's designed from the current set when it
+        //comes back on, whether or not any band has changed since, and coefficientsDesigned() sees the new mode
+        coefficientDesigner.requestRepublish();
+    }
+}
+
+void SimpleEQAudioProcessor::coefficientsDesigned(const ChainCoefficients& chainCoefficients)
+{
+    //until the cascade's impulse response has decayed to -100 dB
+    cascadeTailSamples.store(getDecayLengthInSamples(chainCoefficients, 1.0e-5), std::memory_order_relaxed);
+
+    const auto linearPhase = isLinearPhase();
+
+    if (linearPhase)
+        linearPhaseEngine.design(chainCoefficients);
 
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    //setLatencySamples() notifies the host under a lock and the workers are locked to register with,
+    //both go through the message thread
+    if (linearPhase != appliedLinearPhase.load())
+        triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    applyLinearPhaseMode();
+}
+
+void SimpleEQAudioProcessor::applyLinearPhaseMode()
+{
+    const auto linearPhase = isLinearPhase();
+    appliedLinearPhase = linearPhase;
+
+    linearPhaseEngine.setActive(linearPhase);
+
+    const auto latency = linearPhase ? linearPhaseEngine.getLatencySamples() : 0;
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
@@ -307,6 +618,12 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
 
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
 
+    layout.add(std::make_unique<juce::AudioParameterBool>("Linear Phase", "Linear Phase", false));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("Snapshot Morph", "Snapshot Morph", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph", "Morph", juce::NormalisableRange<float>(0.f, 1.f, 0.f, 1.f), 0.f));
+
     return layout;
 }
 
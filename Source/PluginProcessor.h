@@ -10,97 +10,22 @@
 
 #include <JuceHeader.h>
 
-//for slope settings
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-//struct for apvts params
-struct ChainSettings
-{
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-};
-
-//helper fn to get param values
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-//aliases
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-using MonoChain = juce::dsp::ProcessorChain < CutFilter, Filter, CutFilter>;
-
-//enum to represent each link's position in the chain
-enum ChainPositions {
-    LowCut,
-    Peak,
-    HighCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-//helper to update cut params
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& leftLowCut, const CoefficientType& cutCoefficients, const Slope& lowCutSlope)
-{
-    //first bypass all Filters
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
-
-    switch (lowCutSlope) {
-    case Slope_48:
-    {
-        update<3>(leftLowCut, cutCoefficients);
-        [[fallthrough]]; //intentional fallthrough
-    }
-    case Slope_36:
-    {
-        update<2>(leftLowCut, cutCoefficients);
-    }
-    case Slope_24:
-    {
-        update<1>(leftLowCut, cutCoefficients);
-    }
-    case Slope_12:
-    {
-        update<0>(leftLowCut, cutCoefficients);
-    }
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, 
-        sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, 
-        sampleRate, 2 * (chainSettings.highCutSlope + 1));
-}
+#include "FilterDesign.h"
+#include "CoefficientDesigner.h"
+#include "CascadeEngine.h"
+#include "SpectrumAnalyzer.h"
+#include "LinearPhaseEngine.h"
+#include "PresetBank.h"
+#include "SnapshotMorph.h"
+#include "ProbeRecorder.h"
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private CoefficientDesigner::Listener,
+                                private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -110,12 +35,29 @@ public:
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    //clears the filter state without redesigning anything
+    void reset() override;
+    //offline, the FIR waits for its convolution workers instead of dropping late blocks
+    void setNonRealtime(bool isNonRealtime) noexcept override;
+
+    //samples between coefficient updates while automation is gliding,
+    //smaller is smoother but costs more per block
+    void setControlInterval(int numSamples);
+    int getControlInterval() const;
+
+    //direct form or state-variable sections for one band, takes effect on the next prepareToPlay()
+    void setBandTopology(ChainPositions band, CascadeTopology topology);
+    CascadeTopology getBandTopology(ChainPositions band) const;
+
+    //the cascade runs natively in double when the host asks for it
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -140,19 +82,107 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //the current parameters, with coefficient sets for the standard rates and the current one
+    PresetData createPreset() const;
+    //message thread: if the preset has a set for the current rate the audio thread just swaps to it
+    void applyPreset(const PresetData& preset);
+    bool loadPreset(const PresetBank& bank, int index);
+
+    //message thread: A/B/C/D snapshots that "Morph" moves between while "Snapshot Morph" is on
+    void storeSnapshot(int slot);
+    //sets the parameters to the snapshot, returns false if the slot is empty
+    bool recallSnapshot(int slot);
+    void clearSnapshot(int slot);
+    bool hasSnapshot(int slot) const;
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
-    
+    //pre/post spectra for the editor, idle unless an editor has started it
+    SpectrumAnalyzer spectrumAnalyzer;
+
+   #if SIMPLEEQ_PROBES
+    //callback timings for the editor's profiler overlay, recorded only while it is showing
+    ProbeRecorder probes;
+   #endif
+
 
 private:
-    MonoChain leftChain, rightChain;
+    //all channels' LowCut/Peak/HighCut sections, one SIMD lane per channel; only the engine
+    //for the host's processing precision gets coefficients
+    CascadeEngine<float> filterEngine;
+    CascadeEngine<double> doubleFilterEngine;
+    std::array<CascadeTopology, 3> bandTopologies{};
+
+    //the double path's copy for the float-only analyzer and FIR, sized in prepareToPlay()
+    juce::AudioBuffer<float> floatScratch;
+
+    template<typename Function>
+    void withFilterEngine(Function&& function)
+    {
+        if (isUsingDoublePrecision())
+            function(doubleFilterEngine);
+        else
+            function(filterEngine);
+    }
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
-    void updateFilters();
+    template<typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    ChainParameters chainParameters{ apvts };
+
+    //designs coefficients on the shared designer thread, or at the start of the block when rendering offline
+    CoefficientDesigner coefficientDesigner{ chainParameters };
+    //versions of the bands currently loaded into the chains
+    std::array<juce::uint32, 3> appliedBandVersions{};
+
+    //the same chain as a linear-phase FIR, used instead of filterEngine while "Linear Phase" is on
+    LinearPhaseEngine linearPhaseEngine;
+    std::atomic<float>* linearPhaseParameter{ apvts.getRawParameterValue("Linear Phase") };
+    //audio thread, the mode of the previous block and how long the FIR has been fed digital silence
+    bool wasLinearPhase{ false };
+    int silentSamples{ 0 };
+
+    //the mode the reported latency and the FIR's worker registration are for, so the designer thread can
+    //tell when they're out of date
+    std::atomic<bool> appliedLinearPhase{ false };
+
+    bool isLinearPhase() const noexcept { return linearPhaseParameter->load() > 0.5f; }
+    //message thread only: has the convolution workers follow the FIR only while it's in use, and reports
+    //the latency; setLatencySamples() notifies the host
+    void applyLinearPhaseMode();
+
+    //precomputed morph path through the snapshots, applied instead of the designer's sets while morphing
+    SnapshotMorph snapshotMorph;
+    std::atomic<float>* morphParameter{ apvts.getRawParameterValue("Morph") };
+    std::atomic<float>* snapshotMorphParameter{ apvts.getRawParameterValue("Snapshot Morph") };
+    //audio thread, whether the previous block was morphing and the set it blended into
+    bool wasMorphing{ false };
+    ChainCoefficients morphCoefficients;
+
+    //returns how many bands took new coefficients
+    int applyMorph(bool force);
+
+    //juce::AudioProcessorValueTreeState::Listener override
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    //the tail of the designer's latest set, so getTailLengthSeconds() never designs anything
+    std::atomic<int> cascadeTailSamples{ 0 };
+
+    //CoefficientDesigner::Listener override, measures the cascade's tail, redesigns the FIR while
+    //linear phase is on and has the mode applied when it has changed since it last was
+    void coefficientsDesigned(const ChainCoefficients& chainCoefficients) override;
+
+    //juce::AsyncUpdater override, applies the current mode
+    void handleAsyncUpdate() override;
+
+    void updatePeakFilter(const ChainCoefficients& chainCoefficients);
+    void updateLowCutFilters(const ChainCoefficients& chainCoefficients);
+    void updateHighCutFilters(const ChainCoefficients& chainCoefficients);
+    //loads the bands the designer changed, or every band of its current set if reloadAll is set,
+    //returns how many bands it loaded
+    int updateFilters(bool reloadAll = false);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+    A file of binary presets that is memory-mapped rather than read.
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+namespace
+{
+    constexpr auto bankMagic = "SEQB";
+}
+
+bool PresetBank::open(const juce::File& file)
+{
+    close();
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapping->getData());
+    const auto size = (juce::int64)mapping->getSize();
+
+    if (data == nullptr || size < headerSize || std::memcmp(data, bankMagic, 4) != 0)
+        return false;
+
+    if ((int)juce::ByteOrder::littleEndianShort(data + 4) > currentVersion)
+        return false;
+
+    const auto count = (juce::int64)juce::ByteOrder::littleEndianInt(data + 8);
+
+    if (headerSize + count * indexEntrySize > size)
+        return false;
+
+    for (juce::int64 i = 0; i < count; ++i)
+    {
+        const auto* entry = data + headerSize + i * indexEntrySize;
+        const auto offset = (juce::int64)juce::ByteOrder::littleEndianInt(entry);
+        const auto length = (juce::int64)juce::ByteOrder::littleEndianInt(entry + 4);
+
+        if (offset + length > size)
+            return false;
+    }
+
+    mappedFile = std::move(mapping);
+    numPresets = (int)count;
+
+    return true;
+}
+
+void PresetBank::close()
+{
+    mappedFile.reset();
+    numPresets = 0;
+}
+
+const char* PresetBank::getIndexEntry(int index) const noexcept
+{
+    if (!isOpen() || !juce::isPositiveAndBelow(index, numPresets))
+        return nullptr;
+
+    return static_cast<const char*>(mappedFile->getData()) + headerSize + index * indexEntrySize;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    const auto* entry = getIndexEntry(index);
+
+    if (entry == nullptr)
+        return {};
+
+    const auto* name = entry + 8;
+    return juce::String::fromUTF8(name, (int)strnlen(name, nameSize));
+}
+
+bool PresetBank::getPreset(int index, PresetData& preset) const
+{
+    const auto* entry = getIndexEntry(index);
+
+    if (entry == nullptr)
+        return false;
+
+    const auto offset = juce::ByteOrder::littleEndianInt(entry);
+    const auto length = juce::ByteOrder::littleEndianInt(entry + 4);
+
+    return PresetFormat::read(static_cast<const char*>(mappedFile->getData()) + offset, length, preset);
+}
+
+juce::Result PresetBank::write(const juce::File& file, const std::vector<Entry>& entries)
+{
+    std::vector<juce::MemoryBlock> presets;
+
+    for (auto& entry : entries)
+    {
+        juce::MemoryOutputStream preset;
+        PresetFormat::write(entry.preset, preset);
+        presets.push_back(preset.getMemoryBlock());
+    }
+
+    juce::MemoryOutputStream output;
+
+    output.write(bankMagic, 4);
+    output.writeShort((short)currentVersion);
+    output.writeShort(0);
+    output.writeInt((int)entries.size());
+
+    auto offset = (juce::int64)headerSize + (juce::int64)entries.size() * indexEntrySize;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        output.writeInt((int)offset);
+        output.writeInt((int)presets[i].getSize());
+
+        //truncated to the field, which may cut a multi-byte character; names are for display only
+        char name[nameSize] = {};
+        entries[i].name.copyToUTF8(name, nameSize);
+        output.write(name, nameSize);
+
+        offset += (juce::int64)presets[i].getSize();
+    }
+
+    for (auto& preset : presets)
+        output.write(preset.getData(), preset.getSize());
+
+    if (!file.replaceWithData(output.getData(), output.getDataSize()))
+        return juce::Result::fail("can't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    A file of binary presets that is memory-mapped rather than read.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "PresetFormat.h"
+
+/**
+    Many presets in one file, with an index up front so any preset can be
+    found and parsed straight out of the mapping without reading the rest.
+
+    header  "SEQB", uint16 version, uint16 reserved, uint32 number of presets
+    index   per preset: uint32 offset, uint32 size, 32 bytes of UTF-8 name,
+            zero padded
+    data    the presets in PresetFormat, at their offsets
+
+    The mapping is read-only and the OS pages presets in as they're used, so
+    opening a large bank costs almost nothing and a scene recall across many
+    instances shares the same pages.
+*/
+class PresetBank
+{
+public:
+    struct Entry
+    {
+        juce::String name;
+        PresetData preset;
+    };
+
+    //message thread, checks the header and that every index entry lies inside the file
+    bool open(const juce::File& file);
+    void close();
+
+    bool isOpen() const noexcept { return mappedFile != nullptr; }
+    int getNumPresets() const noexcept { return numPresets; }
+    juce::String getName(int index) const;
+
+    //parses one preset straight from the mapping
+    bool getPreset(int index, PresetData& preset) const;
+
+    static juce::Result write(const juce::File& file, const std::vector<Entry>& entries);
+
+private:
+    static constexpr int currentVersion = 1;
+    static constexpr int headerSize = 12;
+    static constexpr int nameSize = 32;
+    static constexpr int indexEntrySize = 8 + nameSize;
+
+    const char* getIndexEntry(int index) const noexcept;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    int numPresets{ 0 };
+};
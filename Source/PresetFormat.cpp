@@ -0,0 +1,420 @@
+/*
+  ==============================================================================
+
+    PresetFormat.cpp
+    Compact, versioned binary presets that carry precomputed coefficient
+    sets alongside the parameter values.
+
+  ==============================================================================
+*/
+
+#include "PresetFormat.h"
+
+namespace
+{
+    constexpr auto presetMagic = "SEQP";
+    constexpr auto parametersChunk = "PARM";
+    constexpr auto coefficientsChunk = "COEF";
+    constexpr auto snapshotsChunk = "SNAP";
+
+    //sample rates closer than this are the same rate
+    constexpr double sampleRateTolerance = 1.0e-3;
+
+    int toChunkID(const char* id)
+    {
+        return (int)juce::ByteOrder::littleEndianInt(id);
+    }
+
+    void writeChunk(juce::OutputStream& output, const char* id, const juce::MemoryBlock& payload)
+    {
+        output.writeInt(toChunkID(id));
+        output.writeInt((int)payload.getSize());
+        output.write(payload.getData(), payload.getSize());
+    }
+
+    void writeSection(juce::OutputStream& output, const BiquadCoefficients& section)
+    {
+        for (auto coefficient : section)
+            output.writeFloat(coefficient);
+    }
+
+    void readSection(juce::InputStream& input, BiquadCoefficients& section)
+    {
+        for (auto& coefficient : section)
+            coefficient = input.readFloat();
+    }
+
+    //bytes per set in the COEF chunk, before and since the design version and settings
+    constexpr int coefficientSetSizeV1 = 8 + (4 + 1 + 4) * 6 * 4 + 2;
+    constexpr int coefficientSetSize = 8 + 2 + 5 * 4 + (4 + 1 + 4) * 6 * 4 + 2;
+    //bytes per snapshot in the SNAP chunk
+    constexpr int snapshotSize = 1 + 5 * 4 + 2;
+
+    bool readSlope(juce::InputStream& input, Slope& slope)
+    {
+        const auto value = (int)input.readByte();
+
+        if (!juce::isPositiveAndBelow(value, 4))
+            return false;
+
+        slope = static_cast<Slope>(value);
+        return true;
+    }
+
+    bool readParameters(juce::InputStream& input, PresetData& preset)
+    {
+        const auto count = (int)(juce::uint16)input.readShort();
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto length = (int)(juce::uint8)input.readByte();
+            juce::MemoryBlock id;
+
+            if (input.readIntoMemoryBlock(id, length) != (size_t)length || input.getNumBytesRemaining() < 4)
+                return false;
+
+            //a NaN or infinity is left out, so the parameter goes back to its default
+            const auto value = input.readFloat();
+
+            if (std::isfinite(value))
+                preset.parameters.emplace_back(id.toString(), value);
+        }
+
+        return true;
+    }
+
+    //a0 non-zero, every value finite and the poles inside the unit circle, i.e. (a1, a2) / a0 inside the stability triangle
+    bool isUsable(const BiquadCoefficients& section)
+    {
+        for (auto coefficient : section)
+            if (!std::isfinite(coefficient))
+                return false;
+
+        if (section[3] == 0.f)
+            return false;
+
+        const auto a1 = (double)section[4] / section[3];
+        const auto a2 = (double)section[5] / section[3];
+
+        return std::abs(a2) < 1.0 && std::abs(a1) < 1.0 + a2;
+    }
+
+    bool isUsable(const CutCoefficients& sections, Slope slope)
+    {
+        for (int i = 0; i <= slope; ++i)
+            if (!isUsable(sections[(size_t)i]))
+                return false;
+
+        return true;
+    }
+
+    //a parameter value that is a whole slope index
+    bool toSlope(float value, Slope& slope)
+    {
+        if (!(value >= 0.f && value <= (float)Slope_48) || value != std::floor(value))
+            return false;
+
+        slope = static_cast<Slope>((int)value);
+        return true;
+    }
+
+    bool readCoefficients(juce::InputStream& input, PresetData& preset, int version)
+    {
+        const auto count = (int)(juce::uint16)input.readShort();
+        const auto hasDesignVersion = version >= 2;
+
+        if (input.getNumBytesRemaining() < (juce::int64)count * (hasDesignVersion ? coefficientSetSize : coefficientSetSizeV1))
+            return false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            CoefficientSet set;
+            set.sampleRate = input.readDouble();
+
+            if (hasDesignVersion)
+            {
+                set.designVersion = (int)(juce::uint16)input.readShort();
+                set.settings.lowCutFreq = input.readFloat();
+                set.settings.highCutFreq = input.readFloat();
+                set.settings.peakFreq = input.readFloat();
+                set.settings.peakGainInDecibels = input.readFloat();
+                set.settings.peakQuality = input.readFloat();
+            }
+
+            for (auto& section : set.coefficients.lowCut)
+                readSection(input, section);
+
+            readSection(input, set.coefficients.peak);
+
+            for (auto& section : set.coefficients.highCut)
+                readSection(input, section);
+
+            if (!readSlope(input, set.coefficients.lowCutSlope) || !readSlope(input, set.coefficients.highCutSlope))
+                return false;
+
+            set.settings.lowCutSlope = set.coefficients.lowCutSlope;
+            set.settings.highCutSlope = set.coefficients.highCutSlope;
+
+            preset.coefficientSets.push_back(set);
+        }
+
+        return true;
+    }
+
+    bool readSnapshots(juce::InputStream& input, PresetData& preset)
+    {
+        const auto count = (int)(juce::uint8)input.readByte();
+
+        if (input.getNumBytesRemaining() < (juce::int64)count * snapshotSize)
+            return false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto slot = (int)(juce::uint8)input.readByte();
+
+            ChainSettings settings;
+            settings.lowCutFreq = input.readFloat();
+            settings.highCutFreq = input.readFloat();
+            settings.peakFreq = input.readFloat();
+            settings.peakGainInDecibels = input.readFloat();
+            settings.peakQuality = input.readFloat();
+
+            if (!readSlope(input, settings.lowCutSlope) || !readSlope(input, settings.highCutSlope))
+                return false;
+
+            preset.snapshots.emplace_back(slot, settings);
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+const float* PresetData::findParameter(const juce::String& parameterID) const
+{
+    for (auto& parameter : parameters)
+        if (parameter.first == parameterID)
+            return &parameter.second;
+
+    return nullptr;
+}
+
+bool PresetData::getChainSettings(ChainSettings& settings) const
+{
+    const auto* lowCutFreq = findParameter("LowCut Freq");
+    const auto* highCutFreq = findParameter("HighCut Freq");
+    const auto* peakFreq = findParameter("Peak Freq");
+    const auto* peakGain = findParameter("Peak Gain");
+    const auto* peakQuality = findParameter("Peak Quality");
+    const auto* lowCutSlope = findParameter("LowCut Slope");
+    const auto* highCutSlope = findParameter("HighCut Slope");
+
+    if (lowCutFreq == nullptr || highCutFreq == nullptr || peakFreq == nullptr || peakGain == nullptr
+        || peakQuality == nullptr || lowCutSlope == nullptr || highCutSlope == nullptr)
+        return false;
+
+    //slopes index the section arrays, anything else would design past their end
+    if (!toSlope(*lowCutSlope, settings.lowCutSlope) || !toSlope(*highCutSlope, settings.highCutSlope))
+        return false;
+
+    //readParameters() has already dropped NaNs and infinities, but a PresetData needn't come from there
+    for (auto* value : { lowCutFreq, highCutFreq, peakFreq, peakGain, peakQuality })
+        if (!std::isfinite(*value))
+            return false;
+
+    if (*lowCutFreq <= 0.f || *highCutFreq <= 0.f || *peakFreq <= 0.f || *peakQuality <= 0.f)
+        return false;
+
+    settings.lowCutFreq = *lowCutFreq;
+    settings.highCutFreq = *highCutFreq;
+    settings.peakFreq = *peakFreq;
+    settings.peakGainInDecibels = *peakGain;
+    settings.peakQuality = *peakQuality;
+
+    return true;
+}
+
+const ChainCoefficients* PresetData::findCoefficients(double sampleRate, const ChainSettings& settings) const
+{
+    for (auto& set : coefficientSets)
+    {
+        if (std::abs(set.sampleRate - sampleRate) >= sampleRateTolerance)
+            continue;
+
+        const auto& coefficients = set.coefficients;
+
+        //designed from other settings or by a design that has changed since, or damaged: the caller
+        //designs from the settings instead
+        const auto usable = set.designVersion == coefficientDesignVersion
+                         && isLowCutEqual(set.settings, settings)
+                         && isPeakEqual(set.settings, settings)
+                         && isHighCutEqual(set.settings, settings)
+                         && coefficients.lowCutSlope == settings.lowCutSlope
+                         && coefficients.highCutSlope == settings.highCutSlope
+                         && isUsable(coefficients.lowCut, coefficients.lowCutSlope)
+                         && isUsable(coefficients.peak)
+                         && isUsable(coefficients.highCut, coefficients.highCutSlope);
+
+        return usable ? &coefficients : nullptr;
+    }
+
+    return nullptr;
+}
+
+//==============================================================================
+bool PresetFormat::isPreset(const void* data, size_t sizeInBytes)
+{
+    return sizeInBytes >= 8 && std::memcmp(data, presetMagic, 4) == 0;
+}
+
+void PresetFormat::write(const PresetData& preset, juce::OutputStream& output)
+{
+    output.write(presetMagic, 4);
+    output.writeShort((short)currentVersion);
+    output.writeShort(3);
+
+    {
+        juce::MemoryBlock payload;
+        juce::MemoryOutputStream chunk(payload, false);
+
+        chunk.writeShort((short)preset.parameters.size());
+
+        for (auto& parameter : preset.parameters)
+        {
+            const auto id = parameter.first.toUTF8();
+            const auto length = juce::jmin((int)id.sizeInBytes() - 1, 255);
+
+            chunk.writeByte((char)length);
+            chunk.write(id.getAddress(), (size_t)length);
+            chunk.writeFloat(parameter.second);
+        }
+
+        chunk.flush();
+        writeChunk(output, parametersChunk, payload);
+    }
+
+    {
+        juce::MemoryBlock payload;
+        juce::MemoryOutputStream chunk(payload, false);
+
+        chunk.writeShort((short)preset.coefficientSets.size());
+
+        for (auto& set : preset.coefficientSets)
+        {
+            chunk.writeDouble(set.sampleRate);
+            chunk.writeShort((short)set.designVersion);
+            chunk.writeFloat(set.settings.lowCutFreq);
+            chunk.writeFloat(set.settings.highCutFreq);
+            chunk.writeFloat(set.settings.peakFreq);
+            chunk.writeFloat(set.settings.peakGainInDecibels);
+            chunk.writeFloat(set.settings.peakQuality);
+
+            for (auto& section : set.coefficients.lowCut)
+                writeSection(chunk, section);
+
+            writeSection(chunk, set.coefficients.peak);
+
+            for (auto& section : set.coefficients.highCut)
+                writeSection(chunk, section);
+
+            chunk.writeByte((char)set.coefficients.lowCutSlope);
+            chunk.writeByte((char)set.coefficients.highCutSlope);
+        }
+
+        chunk.flush();
+        writeChunk(output, coefficientsChunk, payload);
+    }
+
+    {
+        juce::MemoryBlock payload;
+        juce::MemoryOutputStream chunk(payload, false);
+
+        chunk.writeByte((char)preset.snapshots.size());
+
+        for (auto& snapshot : preset.snapshots)
+        {
+            const auto& settings = snapshot.second;
+
+            chunk.writeByte((char)snapshot.first);
+            chunk.writeFloat(settings.lowCutFreq);
+            chunk.writeFloat(settings.highCutFreq);
+            chunk.writeFloat(settings.peakFreq);
+            chunk.writeFloat(settings.peakGainInDecibels);
+            chunk.writeFloat(settings.peakQuality);
+            chunk.writeByte((char)settings.lowCutSlope);
+            chunk.writeByte((char)settings.highCutSlope);
+        }
+
+        chunk.flush();
+        writeChunk(output, snapshotsChunk, payload);
+    }
+}
+
+bool PresetFormat::read(const void* data, size_t sizeInBytes, PresetData& preset)
+{
+    if (!isPreset(data, sizeInBytes))
+        return false;
+
+    juce::MemoryInputStream input(data, sizeInBytes, false);
+    input.skipNextBytes(4);
+
+    //a preset from a newer build with a changed chunk layout, don't guess
+    const auto version = (int)(juce::uint16)input.readShort();
+
+    if (version > currentVersion)
+        return false;
+
+    const auto numChunks = (int)(juce::uint16)input.readShort();
+
+    preset = {};
+
+    for (int i = 0; i < numChunks; ++i)
+    {
+        if (input.getNumBytesRemaining() < 8)
+            return false;
+
+        const auto id = input.readInt();
+        const auto size = (juce::int64)(juce::uint32)input.readInt();
+
+        if (size > input.getNumBytesRemaining())
+            return false;
+
+        //each chunk is parsed from its own view, so a short payload can't run into the next one
+        juce::MemoryInputStream chunk(static_cast<const char*>(data) + input.getPosition(), (size_t)size, false);
+
+        if (id == toChunkID(parametersChunk) && !readParameters(chunk, preset))
+            return false;
+
+        if (id == toChunkID(coefficientsChunk) && !readCoefficients(chunk, preset, version))
+            return false;
+
+        if (id == toChunkID(snapshotsChunk) && !readSnapshots(chunk, preset))
+            return false;
+
+        input.skipNextBytes(size);
+    }
+
+    return !preset.parameters.empty();
+}
+
+void PresetFormat::addCoefficientSets(PresetData& preset, const ChainSettings& settings, double extraSampleRate)
+{
+    auto addSet = [&](double sampleRate)
+    {
+        if (sampleRate <= 0.0 || preset.findCoefficients(sampleRate, settings) != nullptr)
+            return;
+
+        CoefficientSet set;
+        set.sampleRate = sampleRate;
+        set.settings = settings;
+        set.designVersion = coefficientDesignVersion;
+        makeChainCoefficients(set.coefficients, settings, sampleRate);
+
+        preset.coefficientSets.push_back(set);
+    };
+
+    for (auto sampleRate : standardSampleRates)
+        addSet(sampleRate);
+
+    addSet(extraSampleRate);
+}
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    PresetFormat.h
+    Compact, versioned binary presets that carry precomputed coefficient
+    sets alongside the parameter values.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+//a ChainCoefficients set designed for one sample rate, and what it was designed from
+struct CoefficientSet
+{
+    double sampleRate{ 0.0 };
+    ChainSettings settings;
+    //coefficientDesignVersion of the build that designed it, 0 if that isn't known
+    int designVersion{ 0 };
+    ChainCoefficients coefficients;
+};
+
+//everything a preset holds, parsed
+struct PresetData
+{
+    //parameter ID and value in the parameter's own range
+    std::vector<std::pair<juce::String, float>> parameters;
+    std::vector<CoefficientSet> coefficientSets;
+    //morph snapshots by slot, only the stored ones
+    std::vector<std::pair<int, ChainSettings>> snapshots;
+
+    //nullptr if the preset has no such parameter
+    const float* findParameter(const juce::String& parameterID) const;
+    //the ChainSettings the parameters describe, or false if one is missing or out of range
+    bool getChainSettings(ChainSettings& settings) const;
+    //the set designed for this rate, or nullptr if there is none or it can't be trusted for these
+    //settings: designed from other settings or by another design version, a non-finite value or a
+    //section that isn't stable
+    const ChainCoefficients* findCoefficients(double sampleRate, const ChainSettings& settings) const;
+};
+
+/**
+    Layout, all little-endian:
+
+    header  "SEQP", uint16 version, uint16 number of chunks
+    chunk   4-char ID, uint32 payload size, payload
+
+    PARM    uint16 count, then per parameter: uint8 ID length, UTF-8 ID, float value
+    COEF    uint16 count, then per set: double sample rate, uint16 design
+            version, float LowCut, HighCut and Peak frequency, Peak gain and
+            Peak Q it was designed from, the LowCut, Peak and HighCut sections
+            as floats, uint8 LowCut slope, uint8 HighCut slope
+    SNAP    uint8 count, then per snapshot: uint8 slot, float LowCut, HighCut and
+            Peak frequency, Peak gain, Peak Q, uint8 LowCut slope, uint8 HighCut slope
+
+    Readers skip chunks they don't know, so newer chunks can be added without
+    a version bump; the version only changes when an existing chunk does.
+    Version 1 COEF sets had no design version or settings, they are still
+    read but never trusted.
+*/
+namespace PresetFormat
+{
+    constexpr int currentVersion = 2;
+
+    //sample rates presets carry coefficients for, besides the one they were saved at
+    constexpr std::array<double, 6> standardSampleRates{ 44'100.0, 48'000.0, 88'200.0, 96'000.0, 176'400.0, 192'000.0 };
+
+    //cheap check of the header, to tell presets from the older ValueTree state
+    bool isPreset(const void* data, size_t sizeInBytes);
+
+    void write(const PresetData& preset, juce::OutputStream& output);
+    //reads in place from data, which may be memory-mapped
+    bool read(const void* data, size_t sizeInBytes, PresetData& preset);
+
+    //designs a set for every standard rate and for extraSampleRate, if it isn't one of them
+    void addCoefficientSets(PresetData& preset, const ChainSettings& settings, double extraSampleRate);
+}
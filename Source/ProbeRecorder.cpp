@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ProbeRecorder.cpp
+    Wait-free per-callback timing probes from the audio thread, and the
+    message-thread log that summarises them and writes them out as CSV.
+
+  ==============================================================================
+*/
+
+#include "ProbeRecorder.h"
+
+#if SIMPLEEQ_PROBES
+
+namespace
+{
+    //nearest-rank percentile, reorders values
+    double getPercentile(std::vector<double>& values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const auto rank = juce::jlimit((size_t)0, values.size() - 1, (size_t)std::ceil(fraction * (double)values.size()) - 1);
+        std::nth_element(values.begin(), values.begin() + (std::ptrdiff_t)rank, values.end());
+
+        return values[rank];
+    }
+}
+
+ProbeLog::ProbeLog(int maxRecords)
+{
+    jassert(maxRecords > 0);
+
+    records.resize((size_t)maxRecords);
+    seconds.reserve((size_t)maxRecords);
+    loads.reserve((size_t)maxRecords);
+}
+
+int ProbeLog::collect(ProbeRecorder& recorder)
+{
+    const auto maxRecords = (int)records.size();
+    int numCollectedNow = 0;
+    ProbeRecord record;
+
+    while (recorder.pop(record))
+    {
+        //full, the newest record replaces the oldest
+        if (numRecords < maxRecords)
+            records[(size_t)((oldest + numRecords++) % maxRecords)] = record;
+        else
+        {
+            records[(size_t)oldest] = record;
+            oldest = (oldest + 1) % maxRecords;
+        }
+
+        ++numCollectedNow;
+    }
+
+    numCollected += numCollectedNow;
+    return numCollectedNow;
+}
+
+void ProbeLog::clear()
+{
+    oldest = numRecords = 0;
+    numCollected = 0;
+}
+
+const ProbeRecord& ProbeLog::getRecord(int index) const noexcept
+{
+    return records[(size_t)((oldest + index) % (int)records.size())];
+}
+
+ProbeLog::Summary ProbeLog::summarise(double windowSeconds) const
+{
+    Summary summary;
+
+    if (numRecords == 0)
+        return summary;
+
+    const auto& newest = getRecord(numRecords - 1);
+    const auto windowTicks = juce::Time::secondsToHighResolutionTicks(windowSeconds);
+
+    seconds.clear();
+    loads.clear();
+    juce::int64 bandsProcessed = 0;
+
+    //newest first, until the window is full
+    for (int i = numRecords; --i >= 0;)
+    {
+        const auto& record = getRecord(i);
+
+        if (newest.startTicks - record.startTicks > windowTicks)
+            break;
+
+        const auto time = record.getSeconds();
+        const auto budget = record.getBudgetSeconds();
+        const auto load = budget > 0.0 ? time / budget : 0.0;
+
+        seconds.push_back(time);
+        loads.push_back(load);
+
+        if (load > 1.0)
+            ++summary.overruns;
+
+        bandsProcessed += record.bandsProcessed;
+        summary.bandsRedesigned += record.bandsRedesigned;
+    }
+
+    constexpr auto microseconds = 1.0e6;
+
+    summary.numCallbacks = (int)seconds.size();
+    summary.budget = newest.getBudgetSeconds() * microseconds;
+    summary.averageBandsProcessed = (double)bandsProcessed / summary.numCallbacks;
+
+    summary.max = *std::max_element(seconds.begin(), seconds.end()) * microseconds;
+    summary.maxLoad = *std::max_element(loads.begin(), loads.end());
+    summary.p99Load = getPercentile(loads, 0.99);
+
+    summary.p99 = getPercentile(seconds, 0.99) * microseconds;
+    summary.p90 = getPercentile(seconds, 0.90) * microseconds;
+    summary.p50 = getPercentile(seconds, 0.50) * microseconds;
+
+    return summary;
+}
+
+void ProbeLog::writeCsv(juce::OutputStream& stream) const
+{
+    stream << "callback,start_s,duration_us,budget_us,load,num_samples,sample_rate,bands_processed,bands_redesigned\n";
+
+    if (numRecords == 0)
+        return;
+
+    const auto firstTicks = getRecord(0).startTicks;
+    const auto firstIndex = numCollected - numRecords;
+
+    for (int i = 0; i < numRecords; ++i)
+    {
+        const auto& record = getRecord(i);
+        const auto time = record.getSeconds();
+        const auto budget = record.getBudgetSeconds();
+
+        stream << juce::String(firstIndex + i) << ","
+               << juce::String(juce::Time::highResolutionTicksToSeconds(record.startTicks - firstTicks), 6) << ","
+               << juce::String(time * 1.0e6, 3) << ","
+               << juce::String(budget * 1.0e6, 3) << ","
+               << juce::String(budget > 0.0 ? time / budget : 0.0, 5) << ","
+               << juce::String(record.numSamples) << ","
+               << juce::String(record.sampleRate, 0) << ","
+               << juce::String(record.bandsProcessed) << ","
+               << juce::String(record.bandsRedesigned) << "\n";
+    }
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    ProbeRecorder.h
+    Wait-free per-callback timing probes from the audio thread, and the
+    message-thread log that summarises them and writes them out as CSV.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//0 compiles every probe out of the processor and the editor, set by the "Release (No Probes)" configurations
+#ifndef SIMPLEEQ_PROBES
+ #define SIMPLEEQ_PROBES 1
+#endif
+
+//one processBlock() callback
+struct ProbeRecord
+{
+    //juce::Time::getHighResolutionTicks() on entry and on exit
+    juce::int64 startTicks{ 0 }, endTicks{ 0 };
+    double sampleRate{ 0.0 };
+    int numSamples{ 0 };
+    //cascade bands that ran rather than idled, and bands that took new coefficients
+    int bandsProcessed{ 0 };
+    int bandsRedesigned{ 0 };
+
+    double getSeconds() const noexcept { return juce::Time::highResolutionTicksToSeconds(endTicks - startTicks); }
+    //the real-time budget, the audio the callback had to produce
+    double getBudgetSeconds() const noexcept { return sampleRate > 0.0 ? numSamples / sampleRate : 0.0; }
+};
+
+/**
+    A processor's callback probes.
+
+    Between start() and stop(), which the profiler overlay ties to being on
+    screen, the audio thread takes a timestamp with beginCallback() and hands
+    it back to endCallback() together with the block's counters; that stores
+    one ProbeRecord into a preallocated ring. The ring works like
+    AnalyzerFifo: single producer, single consumer, nothing locks, allocates
+    or waits, and when the consumer falls behind new records are dropped and
+    counted rather than overwriting ones it may be reading. While stopped a
+    callback costs one relaxed load.
+*/
+class ProbeRecorder
+{
+public:
+    static constexpr int capacity = 4096;
+
+    //consumer side; start() drops whatever is left over from the last run
+    void start() noexcept
+    {
+        readCount.store(writeCount.load(std::memory_order_acquire), std::memory_order_release);
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    void stop() noexcept { active.store(false, std::memory_order_relaxed); }
+
+    //audio thread: the ticks to hand to endCallback(), 0 while stopped
+    juce::int64 beginCallback() const noexcept
+    {
+        return active.load(std::memory_order_relaxed) ? juce::Time::getHighResolutionTicks() : 0;
+    }
+
+    //audio thread
+    void endCallback(juce::int64 startTicks, double sampleRate, int numSamples, int bandsProcessed, int bandsRedesigned) noexcept
+    {
+        if (startTicks == 0)
+            return;
+
+        const auto written = writeCount.load(std::memory_order_relaxed);
+
+        if (written - readCount.load(std::memory_order_acquire) >= (juce::uint32)capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        records[(size_t)(written % capacity)] = { startTicks, juce::Time::getHighResolutionTicks(), sampleRate,
+                                                  numSamples, bandsProcessed, bandsRedesigned };
+        writeCount.store(written + 1, std::memory_order_release);
+    }
+
+    //consumer side, returns false if no record is waiting
+    bool pop(ProbeRecord& destination) noexcept
+    {
+        const auto read = readCount.load(std::memory_order_relaxed);
+
+        if (read == writeCount.load(std::memory_order_acquire))
+            return false;
+
+        destination = records[(size_t)(read % capacity)];
+        readCount.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    juce::uint32 getNumDropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::array<ProbeRecord, (size_t)capacity> records{};
+
+    std::atomic<bool> active{ false };
+    std::atomic<juce::uint32> writeCount{ 0 }, readCount{ 0 };
+    std::atomic<juce::uint32> dropped{ 0 };
+};
+
+/**
+    The newest callbacks drained from a ProbeRecorder, on the message thread.
+
+    Keeps up to maxRecords records in storage allocated up front, summarises
+    a recent window of them for the overlay and writes all of them as CSV
+    for offline analysis.
+*/
+class ProbeLog
+{
+public:
+    static constexpr int defaultMaxRecords = 1 << 16;
+
+    explicit ProbeLog(int maxRecords = defaultMaxRecords);
+
+    //moves everything waiting in the recorder into the log, returns how many records that was
+    int collect(ProbeRecorder& recorder);
+    void clear();
+
+    int getNumRecords() const noexcept { return numRecords; }
+
+    //callback times in microseconds, loads as fractions of the budget
+    struct Summary
+    {
+        int numCallbacks{ 0 };
+        double p50{ 0.0 }, p90{ 0.0 }, p99{ 0.0 }, max{ 0.0 };
+        //the newest callback's budget
+        double budget{ 0.0 };
+        double p99Load{ 0.0 }, maxLoad{ 0.0 };
+        //callbacks over budget
+        int overruns{ 0 };
+        double averageBandsProcessed{ 0.0 };
+        int bandsRedesigned{ 0 };
+    };
+
+    //over the callbacks that started within the last windowSeconds of the newest one
+    Summary summarise(double windowSeconds) const;
+
+    //one line per callback, oldest first, with a header row
+    void writeCsv(juce::OutputStream& stream) const;
+
+private:
+    //the index'th oldest record
+    const ProbeRecord& getRecord(int index) const noexcept;
+
+    std::vector<ProbeRecord> records;
+    int oldest{ 0 }, numRecords{ 0 };
+    //callbacks collected since clear(), so the CSV can number them across a full log
+    juce::int64 numCollected{ 0 };
+
+    //summarise() scratch
+    mutable std::vector<double> seconds, loads;
+};
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.cpp
+    The editor's view of the processor's callback probes: live percentiles
+    against the real-time budget and a dump of the raw log to CSV.
+
+  ==============================================================================
+*/
+
+#include "ProfilerOverlay.h"
+
+#if SIMPLEEQ_PROBES
+
+ProfilerOverlay::ProfilerOverlay(ProbeRecorder& recorderToUse) : recorder(recorderToUse)
+{
+    dumpButton.onClick = [this] { dumpCsv(); };
+    addAndMakeVisible(dumpButton);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    stopTimer();
+
+    if (recording)
+        recorder.stop();
+}
+
+void ProfilerOverlay::visibilityChanged()
+{
+    updateRecording();
+}
+
+void ProfilerOverlay::parentHierarchyChanged()
+{
+    updateRecording();
+}
+
+void ProfilerOverlay::updateRecording()
+{
+    const auto shouldRecord = isShowing();
+
+    if (shouldRecord == recording)
+        return;
+
+    recording = shouldRecord;
+
+    if (recording)
+    {
+        //a fresh run, callbacks from before it was hidden would skew the window
+        log.clear();
+        summary = {};
+        recorder.start();
+        startTimerHz(refreshRateHz);
+    }
+    else
+    {
+        stopTimer();
+        recorder.stop();
+        log.collect(recorder);
+    }
+}
+
+void ProfilerOverlay::timerCallback()
+{
+    if (log.collect(recorder) == 0)
+        return;
+
+    summary = log.summarise(summaryWindowSeconds);
+    repaint();
+}
+
+void ProfilerOverlay::resized()
+{
+    dumpButton.setBounds(getLocalBounds().reduced(6).removeFromBottom(22).removeFromRight(80));
+}
+
+void ProfilerOverlay::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.fillAll(Colours::black.withAlpha(0.75f));
+
+    g.setColour(Colours::orange);
+    g.drawRect(getLocalBounds());
+
+    auto area = getLocalBounds().reduced(8, 6);
+    const auto lineHeight = 14;
+
+    g.setFont(Font(Font::getDefaultMonospacedFontName(), 12.f, Font::plain));
+
+    auto drawLine = [&](const String& text, Colour colour)
+    {
+        g.setColour(colour);
+        g.drawText(text, area.removeFromTop(lineHeight), Justification::centredLeft, false);
+    };
+
+    if (summary.numCallbacks == 0)
+    {
+        drawLine("waiting for audio callbacks...", Colours::white);
+        return;
+    }
+
+    //over budget is red, over half of it amber
+    auto loadColour = [](double load)
+    {
+        return load > 1.0 ? Colours::red : load > 0.5 ? Colours::orange : Colours::lightgreen;
+    };
+
+    auto microseconds = [](double value) { return String(value, 1) + " us"; };
+    auto percent = [](double load) { return String(load * 100.0, 1) + "%"; };
+
+    drawLine("callback time, last " + String(summaryWindowSeconds, 0) + " s (" + String(summary.numCallbacks) + " callbacks)",
+             Colours::white);
+    drawLine("  p50 " + microseconds(summary.p50) + "   p90 " + microseconds(summary.p90)
+             + "   p99 " + microseconds(summary.p99) + "   max " + microseconds(summary.max),
+             Colours::white);
+    drawLine("  budget " + microseconds(summary.budget) + "   p99 load " + percent(summary.p99Load)
+             + "   max load " + percent(summary.maxLoad),
+             loadColour(summary.maxLoad));
+    drawLine("  overruns " + String(summary.overruns) + "   bands run " + String(summary.averageBandsProcessed, 2)
+             + "   bands redesigned " + String(summary.bandsRedesigned),
+             summary.overruns > 0 ? Colours::red : Colours::white);
+    drawLine("  logged " + String(log.getNumRecords()) + "   dropped " + String((int)recorder.getNumDropped()),
+             Colours::grey);
+}
+
+void ProfilerOverlay::dumpCsv()
+{
+    const auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                     | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser = std::make_unique<juce::FileChooser>("Dump probe log",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("SimpleEQ probes.csv"), "*.csv");
+
+    fileChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+
+        if (file == juce::File())
+            return;
+
+        //whatever the recorder holds right now belongs in the dump too
+        log.collect(recorder);
+
+        juce::FileOutputStream stream(file);
+
+        if (stream.openedOk())
+        {
+            stream.setPosition(0);
+            stream.truncate();
+            log.writeCsv(stream);
+        }
+    });
+}
+
+#endif
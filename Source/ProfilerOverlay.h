@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.h
+    The editor's view of the processor's callback probes: live percentiles
+    against the real-time budget and a dump of the raw log to CSV.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "ProbeRecorder.h"
+
+/**
+    A translucent panel drawn over the response curve.
+
+    While showing it keeps the processor's ProbeRecorder running, drains it
+    into a ProbeLog a few times a second and shows the callback time
+    percentiles of the last summaryWindowSeconds next to the budget the
+    current block size and sample rate allow. While hidden the recorder is
+    stopped and the log stays as it was, so "Dump CSV" always writes what
+    was last seen.
+*/
+class ProfilerOverlay : public juce::Component, private juce::Timer
+{
+public:
+    static constexpr double summaryWindowSeconds = 2.0;
+    static constexpr int refreshRateHz = 10;
+
+    explicit ProfilerOverlay(ProbeRecorder& recorderToUse);
+    ~ProfilerOverlay() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+    //juce::Component overrides, record only while on screen
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+private:
+    //juce::Timer override
+    void timerCallback() override;
+
+    void updateRecording();
+    void dumpCsv();
+
+    ProbeRecorder& recorder;
+    bool recording{ false };
+
+    ProbeLog log;
+    ProbeLog::Summary summary;
+
+    juce::TextButton dumpButton{ "Dump CSV" };
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerOverlay)
+};
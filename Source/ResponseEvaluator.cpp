@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.cpp
+    Cached magnitude response of the chain on a fixed log-frequency grid,
+    for drawing.
+
+  ==============================================================================
+*/
+
+#include "ResponseEvaluator.h"
+
+bool ResponseEvaluator::BandKey::matches(const BiquadCoefficients* newSections, int newNumSections) const
+{
+    return valid && numSections == newNumSections
+        && std::equal(newSections, newSections + newNumSections, sections.begin());
+}
+
+void ResponseEvaluator::setGrid(int numPoints, double newSampleRate)
+{
+    numPoints = juce::jmax(0, numPoints);
+
+    if (numPoints == getNumPoints() && newSampleRate == sampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+
+    for (auto* v : { &phi, &phiSquared, &numerator, &denominator, &term, &total })
+        v->assign((size_t)numPoints, 0.0);
+
+    for (auto& decibels : bandDecibels)
+        decibels.assign((size_t)numPoints, 0.0);
+
+    for (auto& key : bandKeys)
+        key.valid = false;
+
+    //not prepared yet, update() leaves the curve flat until there is a rate
+    if (sampleRate <= 0.0)
+        return;
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        //same pixel to frequency mapping as the rest of the editor
+        const auto freq = juce::mapToLog10(double(i) / double(numPoints), 20.0, 20'000.0);
+        const auto halfOmega = juce::MathConstants<double>::pi * freq / sampleRate;
+        const auto s = std::sin(halfOmega);
+
+        phi[(size_t)i] = s * s;
+        phiSquared[(size_t)i] = s * s * s * s;
+    }
+}
+
+bool ResponseEvaluator::update(const ChainCoefficients& chainCoefficients)
+{
+    if (total.empty() || sampleRate <= 0.0)
+        return false;
+
+    const std::array<std::pair<const BiquadCoefficients*, int>, 3> bands{
+        std::make_pair(chainCoefficients.lowCut.data(), chainCoefficients.lowCutSlope + 1),
+        std::make_pair(&chainCoefficients.peak, 1),
+        std::make_pair(chainCoefficients.highCut.data(), chainCoefficients.highCutSlope + 1)
+    };
+
+    bool anyChanged = false;
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        if (bandKeys[band].matches(bands[band].first, bands[band].second))
+            continue;
+
+        evaluateBand(band, bands[band].first, bands[band].second);
+        anyChanged = true;
+    }
+
+    if (anyChanged)
+    {
+        const auto n = getNumPoints();
+
+        //a product of magnitudes is a sum in dB
+        juce::FloatVectorOperations::copy(total.data(), bandDecibels[0].data(), n);
+        juce::FloatVectorOperations::add(total.data(), bandDecibels[1].data(), n);
+        juce::FloatVectorOperations::add(total.data(), bandDecibels[2].data(), n);
+        //the same -100 dB floor as Decibels::gainToDecibels
+        juce::FloatVectorOperations::max(total.data(), total.data(), -100.0, n);
+    }
+
+    return anyChanged;
+}
+
+void ResponseEvaluator::evaluateBand(size_t band, const BiquadCoefficients* sections, int numSections)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    const auto n = getNumPoints();
+
+    FVO::fill(numerator.data(), 1.0, n);
+    FVO::fill(denominator.data(), 1.0, n);
+
+    //c0 + c1 phi + c2 phi^2 over the grid, multiplied into destination
+    auto multiplyByQuadratic = [this, n](double* destination, double x0, double x1, double x2)
+    {
+        const auto c0 = (x0 + x1 + x2) * (x0 + x1 + x2);
+        const auto c1 = -4.0 * (x0 * x1 + 4.0 * x0 * x2 + x1 * x2);
+        const auto c2 = 16.0 * x0 * x2;
+
+        FVO::copyWithMultiply(term.data(), phi.data(), c1, n);
+        FVO::addWithMultiply(term.data(), phiSquared.data(), c2, n);
+        FVO::add(term.data(), c0, n);
+        FVO::multiply(destination, term.data(), n);
+    };
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& c = sections[i];
+        multiplyByQuadratic(numerator.data(), c[0], c[1], c[2]);
+        multiplyByQuadratic(denominator.data(), c[3], c[4], c[5]);
+    }
+
+    //|H|^2 to dB, floored well below what the total is clipped to
+    auto* decibels = bandDecibels[band].data();
+
+    for (int i = 0; i < n; ++i)
+    {
+        const auto powerGain = juce::jmax(0.0, numerator[(size_t)i]) / denominator[(size_t)i];
+        decibels[i] = powerGain > 1.0e-20 ? 10.0 * std::log10(powerGain) : -200.0;
+    }
+
+    auto& key = bandKeys[band];
+    std::copy(sections, sections + numSections, key.sections.begin());
+    key.numSections = numSections;
+    key.valid = true;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.h
+    Cached magnitude response of the chain on a fixed log-frequency grid,
+    for drawing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    Evaluates the chain's magnitude response at numPoints log-spaced
+    frequencies between 20 Hz and 20 kHz, one per pixel.
+
+    The grid stores phi = sin^2(w/2) for every point and is only rebuilt when
+    the point count or sample rate changes. Per section
+
+        |H|^2 = ((b0+b1+b2)^2 - 4(b0b1 + 4b0b2 + b1b2) phi + 16 b0b2 phi^2) / (same in a)
+
+    which, unlike the cos(w) form, doesn't cancel catastrophically for cut
+    filters far below their corner. Each term is a scale-and-add over the
+    whole grid, run with FloatVectorOperations, and the band's sections are
+    multiplied together before a single log per point.
+
+    Every band keeps its own decibel curve and the coefficients it was built
+    from; update() only re-evaluates bands whose coefficients changed, so
+    moving one knob costs one band.
+*/
+class ResponseEvaluator
+{
+public:
+    //rebuilds the grid if numPoints or sampleRate changed, which invalidates every band
+    void setGrid(int numPoints, double sampleRate);
+
+    //returns true if any band changed and the total was rebuilt
+    bool update(const ChainCoefficients& chainCoefficients);
+
+    int getNumPoints() const noexcept { return (int)total.size(); }
+    //the whole chain's response in dB, one value per point
+    const double* getDecibels() const noexcept { return total.data(); }
+
+private:
+    //the sections a band was last evaluated with
+    struct BandKey
+    {
+        std::array<BiquadCoefficients, 4> sections{};
+        int numSections{ 0 };
+        bool valid{ false };
+
+        bool matches(const BiquadCoefficients* newSections, int newNumSections) const;
+    };
+
+    void evaluateBand(size_t band, const BiquadCoefficients* sections, int numSections);
+
+    double sampleRate{ 0.0 };
+    std::vector<double> phi, phiSquared;
+    std::vector<double> numerator, denominator, term;
+
+    std::array<BandKey, 3> bandKeys;
+    std::array<std::vector<double>, 3> bandDecibels;
+    std::vector<double> total;
+};
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.cpp
+    A/B/C/D snapshots of the chain and a precomputed table of coefficient
+    sets that morphs between them.
+
+  ==============================================================================
+*/
+
+#include "SnapshotMorph.h"
+
+#include "CascadeKernel.h"
+
+namespace
+{
+    BiquadCoefficients normalised(const BiquadCoefficients& raw)
+    {
+        const auto section = CascadeKernel::normalise<float>(raw);
+        return { section.b0, section.b1, section.b2, 1.f, section.a1, section.a2 };
+    }
+
+    BiquadCoefficients blend(const BiquadCoefficients& a, const BiquadCoefficients& b, float alpha) noexcept
+    {
+        BiquadCoefficients section;
+
+        for (size_t i = 0; i < section.size(); ++i)
+            section[i] = a[i] + (b[i] - a[i]) * alpha;
+
+        return section;
+    }
+
+    //g and k stay positive along the way, so every prototype in between is stable too
+    SvfCoefficients blend(const SvfCoefficients& a, const SvfCoefficients& b, float alpha) noexcept
+    {
+        auto mix = [alpha](double x, double y) { return x + (y - x) * (double)alpha; };
+        return { mix(a.g, b.g), mix(a.k, b.k), mix(a.m0, b.m0), mix(a.m1, b.m1), mix(a.m2, b.m2) };
+    }
+
+    float interpolateLog(float a, float b, float alpha)
+    {
+        return a * std::pow(b / a, alpha);
+    }
+
+    //normalises the active sections and pads the rest with pass-throughs
+    void normaliseCut(CutCoefficients& coefficients, CutSvfCoefficients& prototypes, Slope slope)
+    {
+        for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+            coefficients[i] = (int)i <= slope ? normalised(coefficients[i]) : passThroughCoefficients;
+
+            if ((int)i > slope)
+                prototypes[i] = {};
+        }
+    }
+
+    //one cut band partway along a leg, blending the designs at both slopes if they differ
+    template<typename Designer>
+    Slope designCut(CutCoefficients& destination, CutSvfCoefficients& prototypes,
+                    Slope slopeA, Slope slopeB, float alpha, Designer&& design)
+    {
+        design(destination, prototypes, slopeA);
+        normaliseCut(destination, prototypes, slopeA);
+
+        if (slopeA == slopeB)
+            return slopeA;
+
+        CutCoefficients other;
+        CutSvfCoefficients otherPrototypes;
+        design(other, otherPrototypes, slopeB);
+        normaliseCut(other, otherPrototypes, slopeB);
+
+        for (size_t i = 0; i < destination.size(); ++i)
+        {
+            destination[i] = blend(destination[i], other[i], alpha);
+            prototypes[i] = blend(prototypes[i], otherPrototypes[i], alpha);
+        }
+
+        return juce::jmax(slopeA, slopeB);
+    }
+
+    void designEntry(ChainCoefficients& entry, const ChainSettings& a, const ChainSettings& b, float alpha, double sampleRate)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = interpolateLog(a.lowCutFreq, b.lowCutFreq, alpha);
+        settings.highCutFreq = interpolateLog(a.highCutFreq, b.highCutFreq, alpha);
+        settings.peakFreq = interpolateLog(a.peakFreq, b.peakFreq, alpha);
+        settings.peakQuality = interpolateLog(a.peakQuality, b.peakQuality, alpha);
+        settings.peakGainInDecibels = a.peakGainInDecibels + (b.peakGainInDecibels - a.peakGainInDecibels) * alpha;
+
+        entry.peak = normalised(makePeakCoefficients(settings, sampleRate));
+        entry.peakSvf = makePeakSvfCoefficients(settings, sampleRate);
+
+        entry.lowCutSlope = designCut(entry.lowCut, entry.lowCutSvf, a.lowCutSlope, b.lowCutSlope, alpha,
+            [&](CutCoefficients& destination, CutSvfCoefficients& prototypes, Slope slope)
+            {
+                settings.lowCutSlope = slope;
+                makeLowCutCoefficients(destination, settings, sampleRate);
+                makeLowCutSvfCoefficients(prototypes, settings, sampleRate);
+            });
+
+        entry.highCutSlope = designCut(entry.highCut, entry.highCutSvf, a.highCutSlope, b.highCutSlope, alpha,
+            [&](CutCoefficients& destination, CutSvfCoefficients& prototypes, Slope slope)
+            {
+                settings.highCutSlope = slope;
+                makeHighCutCoefficients(destination, settings, sampleRate);
+                makeHighCutSvfCoefficients(prototypes, settings, sampleRate);
+            });
+    }
+}
+
+//==============================================================================
+void SnapshotMorph::setSampleRate(double newSampleRate)
+{
+    const juce::ScopedLock lock(buildLock);
+
+    sampleRate = newSampleRate;
+    rebuild();
+}
+
+void SnapshotMorph::setSnapshot(int slot, const ChainSettings& settings)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSlots));
+
+    const juce::ScopedLock lock(buildLock);
+
+    snapshots[(size_t)slot] = { true, settings };
+    rebuild();
+}
+
+void SnapshotMorph::clearSnapshot(int slot)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSlots));
+
+    const juce::ScopedLock lock(buildLock);
+
+    snapshots[(size_t)slot] = {};
+    rebuild();
+}
+
+void SnapshotMorph::clearAllSnapshots()
+{
+    const juce::ScopedLock lock(buildLock);
+
+    snapshots = {};
+    rebuild();
+}
+
+bool SnapshotMorph::hasSnapshot(int slot) const
+{
+    const juce::ScopedLock lock(buildLock);
+
+    return juce::isPositiveAndBelow(slot, numSlots) && snapshots[(size_t)slot].stored;
+}
+
+bool SnapshotMorph::getSnapshot(int slot, ChainSettings& settings) const
+{
+    const juce::ScopedLock lock(buildLock);
+
+    if (!juce::isPositiveAndBelow(slot, numSlots) || !snapshots[(size_t)slot].stored)
+        return false;
+
+    settings = snapshots[(size_t)slot].settings;
+    return true;
+}
+
+void SnapshotMorph::rebuild()
+{
+    std::vector<ChainSettings> path;
+
+    for (auto& snapshot : snapshots)
+        if (snapshot.stored)
+            path.push_back(snapshot.settings);
+
+    auto& destination = table.getWriteBuffer();
+    destination.numEntries = 0;
+
+    //with fewer than two snapshots there is nothing to morph between
+    if (sampleRate > 0.0 && path.size() >= 2)
+    {
+        for (size_t leg = 0; leg + 1 < path.size(); ++leg)
+        {
+            //each leg starts where the previous one ended, only the first designs its start point
+            for (int step = leg == 0 ? 0 : 1; step <= stepsPerSegment; ++step)
+            {
+                designEntry(destination.entries[(size_t)destination.numEntries++],
+                            path[leg], path[leg + 1], (float)step / (float)stepsPerSegment, sampleRate);
+            }
+        }
+    }
+
+    table.publish();
+}
+
+//==============================================================================
+bool SnapshotMorph::prepareBlock() noexcept
+{
+    if (table.acquire())
+        tableChanged = true;
+
+    return table.getReadBuffer().numEntries >= 2;
+}
+
+bool SnapshotMorph::getCoefficients(float morph, ChainCoefficients& destination, bool force) noexcept
+{
+    const auto& current = table.getReadBuffer();
+
+    if (current.numEntries < 2 || (!force && !tableChanged && morph == lastMorph))
+        return false;
+
+    tableChanged = false;
+    lastMorph = morph;
+
+    const auto position = juce::jlimit(0.f, 1.f, morph) * (float)(current.numEntries - 1);
+    const auto index = juce::jmin((int)position, current.numEntries - 2);
+    const auto alpha = position - (float)index;
+
+    const auto& a = current.entries[(size_t)index];
+    const auto& b = current.entries[(size_t)index + 1];
+
+    for (size_t i = 0; i < destination.lowCut.size(); ++i)
+    {
+        destination.lowCut[i] = blend(a.lowCut[i], b.lowCut[i], alpha);
+        destination.highCut[i] = blend(a.highCut[i], b.highCut[i], alpha);
+        destination.lowCutSvf[i] = blend(a.lowCutSvf[i], b.lowCutSvf[i], alpha);
+        destination.highCutSvf[i] = blend(a.highCutSvf[i], b.highCutSvf[i], alpha);
+    }
+
+    destination.peak = blend(a.peak, b.peak, alpha);
+    destination.peakSvf = blend(a.peakSvf, b.peakSvf, alpha);
+
+    //both neighbours are padded to the higher of the two orders with pass-throughs
+    destination.lowCutSlope = juce::jmax(a.lowCutSlope, b.lowCutSlope);
+    destination.highCutSlope = juce::jmax(a.highCutSlope, b.highCutSlope);
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.h
+    A/B/C/D snapshots of the chain and a precomputed table of coefficient
+    sets that morphs between them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "TripleBuffer.h"
+
+/**
+    Morphs the chain through up to four stored snapshots.
+
+    Whenever a snapshot or the sample rate changes, the message thread walks
+    the path through the stored slots, in slot order, and designs a coefficient
+    set at stepsPerSegment points along each leg: frequencies and Q move
+    logarithmically, gain in dB linearly. Where the two ends of a leg have
+    different cut slopes, the designs at both slopes are blended, with the
+    shorter cascade padded out by pass-through sections. Every section is
+    stored normalised, so any linear blend of two entries stays inside the
+    (a1, a2) stability triangle, the same argument CascadeEngine's glide
+    relies on. The state-variable prototypes travel alongside and blend g and
+    k, which stay positive.
+
+    The table reaches the audio thread through a TripleBuffer, and all the
+    audio thread does per block is find the two entries either side of the
+    morph position and blend them, at a fixed cost whatever the settings.
+*/
+class SnapshotMorph
+{
+public:
+    static constexpr int numSlots = 4;
+    //table entries per leg between two neighbouring stored snapshots
+    static constexpr int stepsPerSegment = 32;
+    static constexpr int maxEntries = (numSlots - 1) * stepsPerSegment + 1;
+
+    //message thread: rebuilds the table for the new rate
+    void setSampleRate(double newSampleRate);
+
+    //message thread: each rebuilds and publishes the table
+    void setSnapshot(int slot, const ChainSettings& settings);
+    void clearSnapshot(int slot);
+    void clearAllSnapshots();
+
+    //message thread
+    bool hasSnapshot(int slot) const;
+    //the stored settings, or false if the slot is empty
+    bool getSnapshot(int slot, ChainSettings& settings) const;
+
+    //audio thread: picks up a newer table, returns false if fewer than two snapshots are stored
+    bool prepareBlock() noexcept;
+    //audio thread: blends the set at morph, 0 to 1 along the path; returns false and leaves
+    //destination alone if neither the position nor the table changed since the last call,
+    //unless force is set
+    bool getCoefficients(float morph, ChainCoefficients& destination, bool force) noexcept;
+
+private:
+    struct Snapshot
+    {
+        bool stored{ false };
+        ChainSettings settings;
+    };
+
+    struct Table
+    {
+        int numEntries{ 0 };
+        std::array<ChainCoefficients, maxEntries> entries;
+    };
+
+    //caller holds buildLock
+    void rebuild();
+
+    //serialises the producers, never taken by the audio thread
+    juce::CriticalSection buildLock;
+    std::array<Snapshot, numSlots> snapshots;
+    double sampleRate{ 0.0 };
+
+    TripleBuffer<Table> table;
+
+    //audio thread
+    bool tableChanged{ false };
+    float lastMorph{ -1.f };
+};
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+    Pre- and post-EQ spectra, computed on a background thread from audio
+    handed over through wait-free FIFOs.
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer() :
+    juce::Thread("SimpleEQ spectrum analyzer")
+{
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+void SpectrumAnalyzer::setSampleRate(double newSampleRate)
+{
+    sampleRate.store(newSampleRate);
+}
+
+void SpectrumAnalyzer::start(std::function<void()> onNewFrame)
+{
+    stop();
+
+    newFrameCallback = std::move(onNewFrame);
+
+    //stale audio from the last time it ran is of no interest
+    pre.fifo.clear();
+    post.fifo.clear();
+    settingsChanged = true;
+
+    startThread();
+    running = true;
+}
+
+void SpectrumAnalyzer::stop()
+{
+    running = false;
+
+    signalThreadShouldExit();
+    stopThread(1000);
+
+    newFrameCallback = nullptr;
+}
+
+void SpectrumAnalyzer::setSettings(const AnalyzerSettings& newSettings)
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(settingsLock);
+        pendingSettings = newSettings;
+    }
+
+    settingsChanged = true;
+}
+
+AnalyzerSettings SpectrumAnalyzer::getSettings() const
+{
+    const juce::SpinLock::ScopedLockType sl(settingsLock);
+    return pendingSettings;
+}
+
+void SpectrumAnalyzer::pushPre(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    pre.fifo.push(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+}
+
+void SpectrumAnalyzer::pushPost(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    post.fifo.push(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+}
+
+void SpectrumAnalyzer::run()
+{
+    Fifo::Block block;
+
+    while (!threadShouldExit())
+    {
+        if (settingsChanged.exchange(false))
+        {
+            AnalyzerSettings newSettings;
+            {
+                const juce::SpinLock::ScopedLockType sl(settingsLock);
+                newSettings = pendingSettings;
+            }
+            configure(newSettings);
+        }
+
+        bool receivedAudio = false;
+
+        auto drain = [&](Tap& tap)
+        {
+            while (tap.fifo.pop(block))
+            {
+                pushSamples(tap, block.data(), fifoBlockSize);
+                receivedAudio = true;
+            }
+        };
+
+        drain(pre);
+        drain(post);
+
+        //nothing new while the host is stopped, keep the last frame up
+        if (receivedAudio)
+        {
+            auto& frame = frames.getWriteBuffer();
+            decimate(pre, frame.pre);
+            decimate(post, frame.post);
+            frames.publish();
+
+            if (newFrameCallback)
+                newFrameCallback();
+        }
+
+        //roughly one frame per display refresh, the FIFOs hold far more than this
+        wait(16);
+    }
+}
+
+void SpectrumAnalyzer::configure(const AnalyzerSettings& newSettings)
+{
+    settings.fftOrder = juce::jlimit(9, 14, newSettings.fftOrder);
+    settings.overlap = juce::jlimit(1, 16, newSettings.overlap);
+    settings.averaging = juce::jlimit(0.f, 0.99f, newSettings.averaging);
+
+    const auto fftSize = 1 << settings.fftOrder;
+
+    if (fft == nullptr || fft->getSize() != fftSize)
+    {
+        fft = std::make_unique<juce::dsp::FFT>(settings.fftOrder);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>((size_t)fftSize, juce::dsp::WindowingFunction<float>::hann);
+
+        for (auto* tap : { &pre, &post })
+        {
+            tap->history.assign((size_t)fftSize, 0.f);
+            tap->fftData.assign((size_t)fftSize * 2, 0.f);
+            tap->average.assign((size_t)fftSize / 2 + 1, 0.f);
+            tap->samplesSinceLastFft = 0;
+        }
+    }
+}
+
+void SpectrumAnalyzer::pushSamples(Tap& tap, const float* samples, int numSamples)
+{
+    const auto fftSize = (int)tap.history.size();
+    const auto hop = juce::jmax(1, fftSize / settings.overlap);
+
+    for (int done = 0; done < numSamples;)
+    {
+        const auto n = juce::jmin(numSamples - done, hop - tap.samplesSinceLastFft);
+
+        //slide the window along by n samples
+        std::copy(tap.history.begin() + n, tap.history.end(), tap.history.begin());
+        std::copy(samples + done, samples + done + n, tap.history.end() - n);
+
+        done += n;
+        tap.samplesSinceLastFft += n;
+
+        if (tap.samplesSinceLastFft == hop)
+        {
+            tap.samplesSinceLastFft = 0;
+            analyse(tap);
+        }
+    }
+}
+
+void SpectrumAnalyzer::analyse(Tap& tap)
+{
+    const auto fftSize = (int)tap.history.size();
+
+    std::copy(tap.history.begin(), tap.history.end(), tap.fftData.begin());
+    window->multiplyWithWindowingTable(tap.fftData.data(), (size_t)fftSize);
+    fft->performFrequencyOnlyForwardTransform(tap.fftData.data(), true);
+
+    //a full-scale sine reads 0 dB: half the size for the one-sided spectrum, half again for the Hann window's gain
+    const auto scale = 4.f / (float)fftSize;
+    const auto a = settings.averaging;
+
+    for (size_t bin = 0; bin < tap.average.size(); ++bin)
+        tap.average[bin] = tap.average[bin] * a + tap.fftData[bin] * scale * (1.f - a);
+}
+
+void SpectrumAnalyzer::decimate(const Tap& tap, std::array<float, SpectrumFrame::numBins>& destination) const
+{
+    const auto numFftBins = (int)tap.average.size();
+    const auto binWidth = sampleRate.load() / (double)(2 * (numFftBins - 1));
+
+    for (int i = 0; i < SpectrumFrame::numBins; ++i)
+    {
+        //this display bin covers [lowFreq, highFreq)
+        const auto lowFreq = juce::mapToLog10(double(i) / double(SpectrumFrame::numBins), 20.0, 20'000.0);
+        const auto highFreq = juce::mapToLog10(double(i + 1) / double(SpectrumFrame::numBins), 20.0, 20'000.0);
+
+        const auto lowBin = lowFreq / binWidth;
+        const auto highBin = juce::jmin(highFreq / binWidth, (double)(numFftBins - 1));
+
+        float magnitude = 0.f;
+
+        if (lowBin >= numFftBins - 1)
+            magnitude = 0.f;
+        else if ((int)highBin > (int)lowBin)
+        {
+            //wider than an FFT bin: the loudest bin it covers
+            for (auto bin = (int)std::ceil(lowBin); bin <= (int)highBin; ++bin)
+                magnitude = juce::jmax(magnitude, tap.average[(size_t)bin]);
+        }
+        else
+        {
+            //narrower: interpolate at the bin's centre
+            const auto position = (lowBin + highBin) * 0.5;
+            const auto index = (int)position;
+            const auto fraction = (float)(position - index);
+            const auto next = juce::jmin(index + 1, numFftBins - 1);
+
+            magnitude = tap.average[(size_t)index] * (1.f - fraction) + tap.average[(size_t)next] * fraction;
+        }
+
+        destination[(size_t)i] = juce::Decibels::gainToDecibels(magnitude, -120.f);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    Pre- and post-EQ spectra, computed on a background thread from audio
+    handed over through wait-free FIFOs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "AnalyzerFifo.h"
+#include "TripleBuffer.h"
+
+struct AnalyzerSettings
+{
+    //FFT size is 2^fftOrder, 9 to 14
+    int fftOrder{ 12 };
+    //FFTs per FFT length, 1 to 16
+    int overlap{ 4 };
+    //weight of the previous spectrum in the running average, 0 to 0.99
+    float averaging{ 0.7f };
+};
+
+//both spectra in dB at numBins log-spaced frequencies from 20 Hz to 20 kHz
+struct SpectrumFrame
+{
+    static constexpr int numBins = 256;
+
+    std::array<float, numBins> pre{}, post{};
+};
+
+/**
+    Taps the audio before and after the EQ and publishes smoothed spectra.
+
+    processBlock() calls pushPre() and pushPost(), which only mix the block
+    down into an AnalyzerFifo, and only while the analyzer is running. The
+    analyzer thread drains the FIFOs, runs a windowed juce::dsp::FFT every
+    fftSize / overlap samples, averages, decimates to SpectrumFrame::numBins
+    log-frequency bins and publishes the frame through a TripleBuffer. It runs
+    only between start() and stop(), which the editor ties to being on
+    screen, so with no editor open the analyzer costs one atomic load per
+    block.
+*/
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    //any thread
+    void setSampleRate(double newSampleRate);
+
+    //message thread; onNewFrame is called on the analyzer thread after each publish
+    void start(std::function<void()> onNewFrame);
+    void stop();
+
+    //message thread, applied by the analyzer thread before its next FFT
+    void setSettings(const AnalyzerSettings& newSettings);
+    AnalyzerSettings getSettings() const;
+
+    //audio thread
+    bool isRunning() const noexcept { return running.load(std::memory_order_relaxed); }
+    void pushPre(const juce::AudioBuffer<float>& buffer) noexcept;
+    void pushPost(const juce::AudioBuffer<float>& buffer) noexcept;
+
+    //single consumer: returns true if a newer frame was published since the last call
+    bool acquire() noexcept { return frames.acquire(); }
+    const SpectrumFrame& getFrame() const noexcept { return frames.getReadBuffer(); }
+
+private:
+    static constexpr int fifoBlockSize = 256;
+    using Fifo = AnalyzerFifo<fifoBlockSize, 64>;
+
+    //one signal's sliding window and running average
+    struct Tap
+    {
+        Fifo fifo;
+        std::vector<float> history, fftData, average;
+        int samplesSinceLastFft{ 0 };
+    };
+
+    void run() override;
+
+    void configure(const AnalyzerSettings& newSettings);
+    void pushSamples(Tap& tap, const float* samples, int numSamples);
+    void analyse(Tap& tap);
+    void decimate(const Tap& tap, std::array<float, SpectrumFrame::numBins>& destination) const;
+
+    std::atomic<bool> running{ false };
+    std::atomic<double> sampleRate{ 44'100.0 };
+    std::function<void()> newFrameCallback;
+
+    mutable juce::SpinLock settingsLock;
+    AnalyzerSettings pendingSettings;
+    std::atomic<bool> settingsChanged{ true };
+
+    //analyzer thread only
+    AnalyzerSettings settings;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    Tap pre, post;
+
+    TripleBuffer<SpectrumFrame> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
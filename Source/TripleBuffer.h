@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Wait-free single-producer/single-consumer handoff of whole objects.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+    Three slots of T shared between one producer and one consumer.
+
+    The producer fills getWriteBuffer() and calls publish(); the consumer calls
+    acquire() and, if it returns true, reads getReadBuffer(). Neither side ever
+    blocks or waits for the other, and the consumer always sees a complete
+    object: only the slot indices are exchanged, never the contents.
+*/
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    //producer side
+    T& getWriteBuffer() noexcept { return buffers[(std::size_t)writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //consumer side, returns true if a newer object was published since the last call
+    bool acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return buffers[(std::size_t)readIndex]; }
+
+    //only while neither side is running, e.g. to size buffers that hold containers
+    template<typename Function>
+    void forEachBuffer(Function&& function)
+    {
+        for (auto& buffer : buffers)
+            function(buffer);
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<T, 3> buffers{};
+    int writeIndex{ 0 }, readIndex{ 1 };
+    std::atomic<int> middle{ 2 };
+};